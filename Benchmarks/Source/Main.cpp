@@ -0,0 +1,1091 @@
+/*
+  ==============================================================================
+
+    Offline performance benchmarks for Project_EEAVAudioProcessor.
+
+    Results are written as JSON (to stdout, or to the file given with
+    --output <file>) so ns/sample can be tracked across JUCE upgrades and
+    compiler changes. Progress goes to stderr.
+
+    Every run uses the same seeded noise and the same automation curve, and
+    reports the median of several repetitions after a warm-up run.
+
+    Only Release builds give meaningful numbers.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/PluginProcessor.h"
+#include "../../Source/ResponseCurve.h"
+
+namespace
+{
+    constexpr int defaultNumChannels = 2;
+    constexpr double secondsPerRepetition = 1.0;
+    constexpr int numRepetitions = 5;
+
+    // Rate of the automation LFO; tied to time rather than to blocks so
+    // every block size sees the same parameter movement.
+    constexpr double automationRateHz = 0.5;
+
+    constexpr int responseCurveWidth = 600; // The editor's default width
+
+    const int blockSizes[] = { 16, 32, 64, 128, 256, 512, 1024, 2048, 4096 };
+    const double sampleRates[] = { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    const Slope slopes[] = { Slope_12, Slope_24, Slope_36, Slope_48 };
+
+    void setParameter(Project_EEAVAudioProcessor& processor, const juce::String& parameterID, float value)
+    {
+        auto* parameter = processor.apvts.getParameter(parameterID);
+        jassert(parameter != nullptr);
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    }
+
+    juce::AudioBuffer<float> makeNoise(int channels, int numSamples)
+    {
+        juce::AudioBuffer<float> noise(channels, numSamples);
+        juce::Random random(0x5eed);
+
+        for (int channel = 0; channel < channels; ++channel)
+            for (int i = 0; i < numSamples; ++i)
+                noise.setSample(channel, i, random.nextFloat() * 2.f - 1.f);
+
+        return noise;
+    }
+
+    // Moves the first parametric band and both cut filters, like a fast automation
+    // lane, so the smoother never settles.
+    // Path B moves against path A, and only when it is in use, so the linked
+    // cases pay for exactly the same parameter changes as before.
+    // `set` is called with each parameter ID and its value at `timeInSeconds`.
+    template <typename Setter>
+    void forEachAutomatedValue(double timeInSeconds, bool splitPaths, Setter&& set)
+    {
+        auto phase = static_cast<float>(juce::MathConstants<double>::twoPi * automationRateHz * timeInSeconds);
+
+        for (int path = 0; path < (splitPaths ? numChainPaths : 1); ++path)
+        {
+            auto lfo = 0.5f + (path == PathA ? 0.5f : -0.5f) * std::sin(phase);
+
+            set(getParameterID("Peak Freq", path), 100.f * std::pow(2.f, 7.f * lfo));
+            set(getParameterID("Peak Gain", path), 24.f * lfo - 12.f);
+            set(getParameterID("LowCut Freq", path), 20.f + 180.f * lfo);
+            set(getParameterID("HighCut Freq", path), 20000.f - 12000.f * lfo);
+        }
+    }
+
+    void automate(Project_EEAVAudioProcessor& processor, double timeInSeconds, bool splitPaths)
+    {
+        forEachAutomatedValue(timeInSeconds, splitPaths, [&processor](const juce::String& parameterID, float value)
+        {
+            setParameter(processor, parameterID, value);
+        });
+    }
+
+    // The same curve as sample accurate events, `eventsPerBlock` evenly
+    // spaced points per parameter, for the block starting at `blockStart`.
+    // Returns the time of the last point, which the parameters should be set
+    // to after the block.
+    double scheduleAutomation(Project_EEAVAudioProcessor& processor,
+                              double blockStart,
+                              double sampleRate,
+                              int blockSize,
+                              int eventsPerBlock,
+                              bool splitPaths)
+    {
+        auto timeInSeconds = blockStart;
+
+        for (int event = 0; event < eventsPerBlock; ++event)
+        {
+            auto sampleOffset = event * blockSize / eventsPerBlock;
+            timeInSeconds = blockStart + sampleOffset / sampleRate;
+
+            forEachAutomatedValue(timeInSeconds, splitPaths, [&](const juce::String& parameterID, float value)
+            {
+                auto scheduled = processor.scheduleParameterChange(parameterID, value, sampleOffset);
+                jassert(scheduled);
+                juce::ignoreUnused(scheduled);
+            });
+        }
+
+        return timeInSeconds;
+    }
+
+    double median(std::vector<double> values)
+    {
+        std::sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    }
+
+    struct ProcessCase
+    {
+        FilterEngine engine{ BiquadEngine };
+        bool smoothing{ false };
+        bool automated{ false };
+        double sampleRate{ 48000.0 };
+        int blockSize{ 512 };
+        Slope slope{ Slope_12 };
+        int smoothingUpdateInterval{ 32 };
+        int oversamplingFactorLog2{ 0 };
+        int numChannels{ defaultNumChannels };
+        StereoMode stereoMode{ StereoLinked };
+        int numBands{ 1 };
+        bool doublePrecision{ false };
+        bool silentInput{ false };
+
+        // Sample accurate events per automated parameter per block, instead
+        // of setting the parameters once before each block. Needs `automated`.
+        int eventsPerBlock{ 0 };
+        int minimumEventSpacing{ 16 };
+
+        // Each repetition is one whole morph between two scenes.
+        bool morphing{ false };
+
+        // Band 0 as a dynamic band, keyed by the input and held well above
+        // its threshold so it keeps moving.
+        bool dynamic{ false };
+    };
+
+    // Median cost of processBlock, in ns per sample (all channels).
+    double measureProcessBlock(const ProcessCase& c)
+    {
+        Project_EEAVAudioProcessor processor;
+
+        setParameter(processor, "Engine", static_cast<float>(c.engine));
+        setParameter(processor, "Smoothing", c.smoothing ? 1.f : 0.f);
+        setParameter(processor, "LowCut Slope", static_cast<float>(c.slope));
+        setParameter(processor, "HighCut Slope", static_cast<float>(c.slope));
+        setParameter(processor, "LowCut Freq", 80.f);
+        setParameter(processor, "HighCut Freq", 12000.f);
+        setParameter(processor, "Peak Gain", 6.f);
+        setParameter(processor, "Oversampling", static_cast<float>(c.oversamplingFactorLog2));
+        setParameter(processor, "Stereo Mode", static_cast<float>(c.stereoMode));
+        setParameter(processor, getParameterID("LowCut Slope", PathB), static_cast<float>(c.slope));
+        setParameter(processor, getParameterID("HighCut Slope", PathB), static_cast<float>(c.slope));
+        setParameter(processor, getParameterID("LowCut Freq", PathB), 120.f);
+        setParameter(processor, getParameterID("HighCut Freq", PathB), 9000.f);
+        setParameter(processor, getParameterID("Peak Gain", PathB), -6.f);
+        processor.setSmoothingUpdateInterval(c.smoothingUpdateInterval);
+        processor.setMinimumEventSpacing(c.minimumEventSpacing);
+
+        for (int band = 1; band < c.numBands; ++band)
+        {
+            auto gain = band % 2 == 0 ? 6.f : -6.f;
+
+            for (int path = 0; path < numChainPaths; ++path)
+            {
+                setParameter(processor, getParameterID(getBandParameterID("Peak On", band), path), 1.f);
+                setParameter(processor, getParameterID(getBandParameterID("Peak Gain", band), path), path == PathA ? gain : -gain);
+            }
+        }
+
+        if (c.morphing)
+        {
+            processor.storeSnapshot(0);
+
+            for (int path = 0; path < numChainPaths; ++path)
+            {
+                setParameter(processor, getParameterID("LowCut Freq", path), 250.f);
+                setParameter(processor, getParameterID("HighCut Freq", path), 5000.f);
+
+                for (int band = 0; band < c.numBands; ++band)
+                {
+                    setParameter(processor, getParameterID(getBandParameterID("Peak Freq", band), path), 3000.f);
+                    setParameter(processor, getParameterID(getBandParameterID("Peak Quality", band), path), 4.f);
+                }
+            }
+
+            processor.storeSnapshot(1);
+            setParameter(processor, "Morph Time", static_cast<float>(secondsPerRepetition));
+        }
+
+        if (c.dynamic)
+        {
+            setParameter(processor, "Dynamic", 1.f);
+            setParameter(processor, "Dynamic Threshold", -40.f);
+            setParameter(processor, "Dynamic Attack", 1.f);
+            setParameter(processor, "Dynamic Release", 20.f);
+        }
+
+        // Offline, so parameter changes are designed on this thread and the
+        // numbers don't depend on the designer thread's scheduling.
+        processor.setNonRealtime(true);
+        processor.setProcessingPrecision(c.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                           : juce::AudioProcessor::singlePrecision);
+        processor.setPlayConfigDetails(c.numChannels, c.numChannels, c.sampleRate, c.blockSize);
+        processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+        auto noise = makeNoise(c.numChannels, c.blockSize);
+
+        if (c.silentInput)
+            noise.clear();
+        juce::AudioBuffer<float> buffer(c.numChannels, c.blockSize);
+        juce::AudioBuffer<double> doubleBuffer(c.doublePrecision ? c.numChannels : 0, c.doublePrecision ? c.blockSize : 0);
+        juce::MidiBuffer midi;
+
+        auto numBlocks = juce::jmax(1, static_cast<int>(secondsPerRepetition * c.sampleRate / c.blockSize));
+        juce::int64 samplePosition = 0;
+        int morphTarget = 0;
+
+        auto runRepetition = [&]
+        {
+            juce::int64 ticks = 0;
+
+            // Staging the morph is message thread work, so it isn't timed.
+            if (c.morphing)
+                processor.morphToSnapshot(morphTarget++ % 2);
+
+            for (int blockIndex = 0; blockIndex < numBlocks; ++blockIndex)
+            {
+                if (c.doublePrecision)
+                    doubleBuffer.makeCopyOf(noise, true);
+                else
+                    buffer.makeCopyOf(noise, true);
+
+                auto start = juce::Time::getHighResolutionTicks();
+
+                auto blockStart = static_cast<double>(samplePosition) / c.sampleRate;
+                auto splitPaths = c.stereoMode != StereoLinked;
+                auto lastEventTime = blockStart;
+
+                if (c.automated && c.eventsPerBlock > 0)
+                    lastEventTime = scheduleAutomation(processor, blockStart, c.sampleRate, c.blockSize, c.eventsPerBlock, splitPaths);
+                else if (c.automated)
+                    automate(processor, blockStart, splitPaths);
+
+                if (c.doublePrecision)
+                    processor.processBlock(doubleBuffer, midi);
+                else
+                    processor.processBlock(buffer, midi);
+
+                // Leave the parameters where the events ended, as a host would.
+                if (c.automated && c.eventsPerBlock > 0)
+                    automate(processor, lastEventTime, splitPaths);
+                ticks += juce::Time::getHighResolutionTicks() - start;
+
+                samplePosition += c.blockSize;
+            }
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds(ticks);
+            return seconds * 1.0e9 / (static_cast<double>(numBlocks) * c.blockSize);
+        };
+
+        runRepetition(); // Warm up caches, the designer and the smoother
+
+        std::vector<double> repetitions;
+
+        for (int i = 0; i < numRepetitions; ++i)
+            repetitions.push_back(runRepetition());
+
+        processor.releaseResources();
+
+        return median(repetitions);
+    }
+
+    // Median cost of one call of `function`, in ns. `function` is given the
+    // iteration index so it can vary its input and defeat any caching.
+    template<typename Function>
+    double measureNanosecondsPerCall(int iterationsPerRepetition, Function&& function)
+    {
+        auto runRepetition = [&]
+        {
+            auto start = juce::Time::getHighResolutionTicks();
+
+            for (int i = 0; i < iterationsPerRepetition; ++i)
+                function(i);
+
+            auto seconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start);
+            return seconds * 1.0e9 / iterationsPerRepetition;
+        };
+
+        runRepetition();
+
+        std::vector<double> repetitions;
+
+        for (int i = 0; i < numRepetitions; ++i)
+            repetitions.push_back(runRepetition());
+
+        return median(repetitions);
+    }
+
+    // Settings that differ in every field the designs look at.
+    ChainSettings makeSettings(int index, Slope slope, FilterType filterType)
+    {
+        auto position = static_cast<float>(index % 64) / 64.f;
+
+        ChainSettings settings;
+        settings.peakFreq[0] = 100.f * std::pow(2.f, 7.f * position);
+        settings.peakGainInDecibels[0] = 24.f * position - 12.f;
+        settings.peakQuality[0] = 0.5f + 4.f * position;
+        settings.filterName[0] = filterType;
+        settings.bandEnabled[0] = true;
+        settings.lowCutFreq = 20.f + 180.f * position;
+        settings.highCutFreq = 20000.f - 12000.f * position;
+        settings.lowCutSlope = slope;
+        settings.highCutSlope = slope;
+
+        return settings;
+    }
+
+    juce::String getEngineName(FilterEngine engine)
+    {
+        switch (engine)
+        {
+        case TPTEngine:
+            return "TPT";
+        case LinearPhaseEngine:
+            return "LinearPhase";
+        default:
+            return "Biquad";
+        }
+    }
+
+    juce::String getStereoModeName(StereoMode stereoMode)
+    {
+        switch (stereoMode)
+        {
+        case LeftRight:
+            return "LeftRight";
+        case MidSide:
+            return "MidSide";
+        default:
+            return "Linked";
+        }
+    }
+
+    juce::String getFilterTypeName(FilterType filterType)
+    {
+        switch (filterType)
+        {
+        case PeakFilter:
+            return "Peak";
+        case NotchFilter:
+            return "Notch";
+        case BandPassFilter:
+            return "BandPass";
+        default:
+            return "Unknown";
+        }
+    }
+
+    int getSlopeInDecibelsPerOctave(Slope slope)
+    {
+        return 12 + 12 * static_cast<int>(slope);
+    }
+
+    class Results
+    {
+    public:
+        juce::DynamicObject* add(const juce::String& benchmark)
+        {
+            auto* result = new juce::DynamicObject();
+            result->setProperty("benchmark", benchmark);
+            results.add(juce::var(result));
+
+            return result;
+        }
+
+        juce::String toJSON() const
+        {
+            auto* meta = new juce::DynamicObject();
+            meta->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+            meta->setProperty("cpu", juce::SystemStats::getCpuModel());
+            meta->setProperty("operatingSystem", juce::SystemStats::getOperatingSystemName());
+            meta->setProperty("simdLanes", SIMDFilterChain<float>::channelsPerGroup);
+            meta->setProperty("doubleSimdLanes", SIMDFilterChain<double>::channelsPerGroup);
+            meta->setProperty("numChannels", defaultNumChannels);
+            meta->setProperty("secondsPerRepetition", secondsPerRepetition);
+            meta->setProperty("repetitions", numRepetitions);
+            meta->setProperty("buildDate", juce::String(__DATE__) + " " + __TIME__);
+           #if JUCE_DEBUG
+            meta->setProperty("build", "Debug");
+           #else
+            meta->setProperty("build", "Release");
+           #endif
+
+            auto* root = new juce::DynamicObject();
+            root->setProperty("meta", juce::var(meta));
+            root->setProperty("results", results);
+
+            return juce::JSON::toString(juce::var(root));
+        }
+
+    private:
+        juce::Array<juce::var> results;
+    };
+
+    void benchmarkProcessBlock(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine })
+            for (auto automated : { false, true })
+                for (auto sampleRate : sampleRates)
+                    for (auto blockSize : blockSizes)
+                        for (auto slope : slopes)
+                        {
+                            ProcessCase c;
+                            c.engine = engine;
+                            c.smoothing = engine == TPTEngine;
+                            c.automated = automated;
+                            c.sampleRate = sampleRate;
+                            c.blockSize = blockSize;
+                            c.slope = slope;
+
+                            std::cerr << "processBlock " << getEngineName(engine)
+                                      << (automated ? " automated " : " static ")
+                                      << sampleRate << " Hz " << blockSize << " samples "
+                                      << getSlopeInDecibelsPerOctave(slope) << " dB/oct" << std::endl;
+
+                            auto* result = results.add("processBlock");
+                            result->setProperty("engine", getEngineName(engine));
+                            result->setProperty("smoothing", c.smoothing);
+                            result->setProperty("scenario", automated ? "automated" : "static");
+                            result->setProperty("sampleRate", sampleRate);
+                            result->setProperty("blockSize", blockSize);
+                            result->setProperty("slope", getSlopeInDecibelsPerOctave(slope));
+                            result->setProperty("nsPerSample", measureProcessBlock(c));
+                        }
+    }
+
+    // Cost of smoothed biquad processing as a function of the coefficient update interval.
+    void benchmarkSmoothingUpdateInterval(Results& results)
+    {
+        for (int interval : { 1, 2, 4, 8, 16, 32, 64, 128, 256, 512 })
+        {
+            std::cerr << "smoothing update interval " << interval << std::endl;
+
+            ProcessCase c;
+            c.smoothing = true;
+            c.automated = true;
+            c.smoothingUpdateInterval = interval;
+
+            auto* result = results.add("smoothingUpdateInterval");
+            result->setProperty("engine", getEngineName(c.engine));
+            result->setProperty("sampleRate", c.sampleRate);
+            result->setProperty("blockSize", c.blockSize);
+            result->setProperty("interval", interval);
+            result->setProperty("nsPerSample", measureProcessBlock(c));
+        }
+    }
+
+    // Cost of each oversampling factor, at a typical session rate and block size.
+    void benchmarkOversampling(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine })
+            for (auto automated : { false, true })
+                for (int factorLog2 = 0; factorLog2 <= 3; ++factorLog2)
+                {
+                    std::cerr << "oversampling " << (1 << factorLog2) << "x " << getEngineName(engine)
+                              << (automated ? " automated" : " static") << std::endl;
+
+                    ProcessCase c;
+                    c.engine = engine;
+                    c.smoothing = engine == TPTEngine;
+                    c.automated = automated;
+                    c.slope = Slope_48;
+                    c.oversamplingFactorLog2 = factorLog2;
+
+                    auto* result = results.add("oversampling");
+                    result->setProperty("engine", getEngineName(engine));
+                    result->setProperty("scenario", automated ? "automated" : "static");
+                    result->setProperty("sampleRate", c.sampleRate);
+                    result->setProperty("blockSize", c.blockSize);
+                    result->setProperty("factor", 1 << factorLog2);
+                    result->setProperty("nsPerSample", measureProcessBlock(c));
+                }
+    }
+
+    // Cost per channel from mono up to 7.1.4. The IIR engines fill one SIMD
+    // group at a time, so the per channel cost drops until a group is full.
+    void benchmarkChannelCount(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine, LinearPhaseEngine })
+            for (auto channels : { 1, 2, 4, 6, 8, 10, 12 })
+            {
+                std::cerr << "channels " << channels << " " << getEngineName(engine) << std::endl;
+
+                ProcessCase c;
+                c.engine = engine;
+                c.smoothing = engine == TPTEngine;
+                c.automated = true;
+                c.slope = Slope_48;
+                c.numChannels = channels;
+
+                auto nsPerSample = measureProcessBlock(c);
+
+                auto* result = results.add("channelCount");
+                result->setProperty("engine", getEngineName(engine));
+                result->setProperty("sampleRate", c.sampleRate);
+                result->setProperty("blockSize", c.blockSize);
+                result->setProperty("numChannels", channels);
+                result->setProperty("nsPerSample", nsPerSample);
+                result->setProperty("nsPerChannelSample", nsPerSample / channels);
+            }
+    }
+
+    // Cost of splitting the first channel pair into two paths, against
+    // running both channels through the same filters.
+    void benchmarkStereoMode(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine, LinearPhaseEngine })
+            for (auto stereoMode : { StereoLinked, LeftRight, MidSide })
+            {
+                std::cerr << "stereo mode " << getStereoModeName(stereoMode) << " " << getEngineName(engine) << std::endl;
+
+                ProcessCase c;
+                c.engine = engine;
+                c.smoothing = engine == TPTEngine;
+                c.automated = true;
+                c.slope = Slope_48;
+                c.stereoMode = stereoMode;
+
+                auto* result = results.add("stereoMode");
+                result->setProperty("engine", getEngineName(engine));
+                result->setProperty("stereoMode", getStereoModeName(stereoMode));
+                result->setProperty("sampleRate", c.sampleRate);
+                result->setProperty("blockSize", c.blockSize);
+                result->setProperty("nsPerSample", measureProcessBlock(c));
+            }
+    }
+
+    // Cost against the number of parametric bands switched on; the bands
+    // left off should cost nothing.
+    void benchmarkBandCount(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine })
+            for (auto numBands : { 1, 4, 8, maxBands })
+            {
+                std::cerr << "band count " << numBands << " " << getEngineName(engine) << std::endl;
+
+                ProcessCase c;
+                c.engine = engine;
+                c.smoothing = engine == TPTEngine;
+                c.automated = true;
+                c.slope = Slope_48;
+                c.numBands = numBands;
+
+                auto nsPerSample = measureProcessBlock(c);
+
+                auto* result = results.add("bandCount");
+                result->setProperty("engine", getEngineName(engine));
+                result->setProperty("numBands", numBands);
+                result->setProperty("sampleRate", c.sampleRate);
+                result->setProperty("blockSize", c.blockSize);
+                result->setProperty("nsPerSample", nsPerSample);
+                result->setProperty("nsPerBandSample", nsPerSample / numBands);
+            }
+    }
+
+    // Cost of processing in double against float, with the deep cut filters
+    // double precision is there for.
+    void benchmarkPrecision(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine, LinearPhaseEngine })
+            for (auto sampleRate : { 48000.0, 192000.0 })
+                for (auto doublePrecision : { false, true })
+                {
+                    std::cerr << "precision " << (doublePrecision ? "double " : "float ") << getEngineName(engine)
+                              << " " << sampleRate << " Hz" << std::endl;
+
+                    ProcessCase c;
+                    c.engine = engine;
+                    c.smoothing = engine == TPTEngine;
+                    c.automated = true;
+                    c.sampleRate = sampleRate;
+                    c.slope = Slope_48;
+                    c.doublePrecision = doublePrecision;
+
+                    auto* result = results.add("precision");
+                    result->setProperty("engine", getEngineName(engine));
+                    result->setProperty("precision", doublePrecision ? "double" : "float");
+                    result->setProperty("sampleRate", sampleRate);
+                    result->setProperty("blockSize", c.blockSize);
+                    result->setProperty("nsPerSample", measureProcessBlock(c));
+                }
+    }
+
+    // Cost of a track that is playing nothing, against one playing noise.
+    // Once the filters have rung down the silent case should only pay for
+    // the silence check.
+    void benchmarkSilence(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine, LinearPhaseEngine })
+            for (auto silentInput : { false, true })
+            {
+                std::cerr << "silence " << (silentInput ? "silent " : "noise ") << getEngineName(engine) << std::endl;
+
+                ProcessCase c;
+                c.engine = engine;
+                c.smoothing = engine == TPTEngine;
+                c.slope = Slope_48;
+                c.silentInput = silentInput;
+
+                auto* result = results.add("silence");
+                result->setProperty("engine", getEngineName(engine));
+                result->setProperty("input", silentInput ? "silent" : "noise");
+                result->setProperty("sampleRate", c.sampleRate);
+                result->setProperty("blockSize", c.blockSize);
+                result->setProperty("nsPerSample", measureProcessBlock(c));
+            }
+    }
+
+    // Cost of sample accurate automation against the number of events per
+    // block, at 2048 sample blocks. 0 events is the same curve set once per
+    // block; the minimum event spacing caps the sub-blocks at 128 per block.
+    void benchmarkParameterEvents(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine })
+            for (auto smoothing : { false, true })
+                for (auto eventsPerBlock : { 0, 1, 4, 16, 64, 128 })
+                {
+                    std::cerr << "parameter events " << eventsPerBlock << " " << getEngineName(engine)
+                              << (smoothing ? " smoothed" : "") << std::endl;
+
+                    ProcessCase c;
+                    c.engine = engine;
+                    c.smoothing = smoothing;
+                    c.automated = true;
+                    c.blockSize = 2048;
+                    c.slope = Slope_48;
+                    c.eventsPerBlock = eventsPerBlock;
+
+                    auto* result = results.add("parameterEvents");
+                    result->setProperty("engine", getEngineName(engine));
+                    result->setProperty("smoothing", smoothing);
+                    result->setProperty("eventsPerBlock", eventsPerBlock);
+                    result->setProperty("minimumEventSpacing", c.minimumEventSpacing);
+                    result->setProperty("sampleRate", c.sampleRate);
+                    result->setProperty("blockSize", c.blockSize);
+                    result->setProperty("nsPerSample", measureProcessBlock(c));
+                }
+    }
+
+    // Cost of the biquads following a scene morph against holding still.
+    // During a morph every sub-block interpolates two staged keyframes.
+    void benchmarkMorph(Results& results)
+    {
+        for (auto numBands : { 1, maxBands })
+            for (auto morphing : { false, true })
+            {
+                std::cerr << "morph " << numBands << " bands" << (morphing ? " morphing" : "") << std::endl;
+
+                ProcessCase c;
+                c.slope = Slope_48;
+                c.numBands = numBands;
+                c.morphing = morphing;
+
+                auto* result = results.add("morph");
+                result->setProperty("numBands", numBands);
+                result->setProperty("morphing", morphing);
+                result->setProperty("updateInterval", c.smoothingUpdateInterval);
+                result->setProperty("sampleRate", c.sampleRate);
+                result->setProperty("blockSize", c.blockSize);
+                result->setProperty("nsPerSample", measureProcessBlock(c));
+            }
+    }
+
+    // Cost of the dynamic band against the same static band. The gain
+    // change is picked up once per update interval, and only recalculates
+    // band 0 when it has moved.
+    void benchmarkDynamicBand(Results& results)
+    {
+        for (auto engine : { BiquadEngine, TPTEngine })
+            for (auto smoothing : { false, true })
+                for (auto dynamic : { false, true })
+                {
+                    std::cerr << "dynamic band " << getEngineName(engine) << (smoothing ? " smoothed" : "")
+                              << (dynamic ? " dynamic" : "") << std::endl;
+
+                    ProcessCase c;
+                    c.engine = engine;
+                    c.smoothing = smoothing;
+                    c.slope = Slope_48;
+                    c.dynamic = dynamic;
+
+                    auto* result = results.add("dynamicBand");
+                    result->setProperty("engine", getEngineName(engine));
+                    result->setProperty("smoothing", smoothing);
+                    result->setProperty("dynamic", dynamic);
+                    result->setProperty("updateInterval", c.smoothingUpdateInterval);
+                    result->setProperty("sampleRate", c.sampleRate);
+                    result->setProperty("blockSize", c.blockSize);
+                    result->setProperty("nsPerSample", measureProcessBlock(c));
+                }
+    }
+
+    void benchmarkFilterDesign(Results& results)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int iterations = 2000;
+
+        double sink = 0.0;
+
+        for (auto filterType : { PeakFilter, NotchFilter, BandPassFilter })
+        {
+            std::cerr << "makeBandFilter " << getFilterTypeName(filterType) << std::endl;
+
+            auto* result = results.add("makeBandFilter");
+            result->setProperty("filterType", getFilterTypeName(filterType));
+            result->setProperty("nsPerCall", measureNanosecondsPerCall(iterations, [&](int i)
+            {
+                auto coefficients = makeBandFilter<float>(makeSettings(i, Slope_12, filterType), 0, sampleRate);
+                sink += coefficients->coefficients[0];
+            }));
+        }
+
+        for (auto slope : slopes)
+        {
+            std::cerr << "filter design " << getSlopeInDecibelsPerOctave(slope) << " dB/oct" << std::endl;
+
+            ChainCoefficients coefficients;
+
+            auto* designResult = results.add("designChainCoefficients");
+            designResult->setProperty("slope", getSlopeInDecibelsPerOctave(slope));
+            designResult->setProperty("nsPerCall", measureNanosecondsPerCall(iterations, [&](int i)
+            {
+                designChainCoefficients(coefficients, makeSettings(i, slope, PeakFilter), sampleRate, AllStagesDirty);
+                sink += coefficients.bands[0].b0;
+            }));
+
+            auto* calculateResult = results.add("calculateChainCoefficients");
+            calculateResult->setProperty("slope", getSlopeInDecibelsPerOctave(slope));
+            calculateResult->setProperty("nsPerCall", measureNanosecondsPerCall(iterations, [&](int i)
+            {
+                calculateChainCoefficients(coefficients, makeSettings(i, slope, PeakFilter), sampleRate, AllStagesDirty);
+                sink += coefficients.bands[0].b0;
+            }));
+        }
+
+        // Keeps the optimiser from discarding the designs.
+        if (sink == 0.123)
+            std::cerr << sink << std::endl;
+    }
+
+    // Worst magnitude error, in dB, of one stage of `settings` designed with
+    // `designMethod` at `factor` times `sampleRate`, against the bilinear
+    // design at 16 times, where cramping is negligible below 20 kHz. Levels
+    // below -60 dB are compared as -60 dB, so a notch's depth doesn't count.
+    double measureDesignError(ChainSettings settings, int stages, int designMethod, int factor, double sampleRate)
+    {
+        constexpr int numPoints = 256;
+        constexpr double floorInDecibels = -60.0;
+        constexpr int referenceFactor = 16;
+
+        ChainCoefficients coefficients, reference;
+
+        settings.designMethod = designMethod;
+        calculateChainCoefficients(coefficients, settings, sampleRate * factor, stages);
+
+        settings.designMethod = BilinearDesign;
+        calculateChainCoefficients(reference, settings, sampleRate * referenceFactor, stages);
+
+        auto toDecibels = [](double magnitude) { return juce::Decibels::gainToDecibels(magnitude, floorInDecibels); };
+        double maxError = 0.0;
+
+        for (int point = 0; point < numPoints; ++point)
+        {
+            auto frequency = 20.0 * std::pow(1000.0, static_cast<double>(point) / (numPoints - 1));
+            auto magnitude = getChainMagnitude(coefficients, frequency, sampleRate * factor);
+            auto expected = getChainMagnitude(reference, frequency, sampleRate * referenceFactor);
+
+            maxError = juce::jmax(maxError, std::abs(toDecibels(magnitude) - toDecibels(expected)));
+        }
+
+        return maxError;
+    }
+
+    // Accuracy near Nyquist of the matched design at the base rate against
+    // the bilinear one at the base rate and oversampled, and the design cost
+    // of each method. The cost of running oversampled is measured by
+    // benchmarkOversampling().
+    void benchmarkMatchedDesign(Results& results)
+    {
+        constexpr int iterations = 2000;
+
+        struct Contender
+        {
+            const char* name;
+            int designMethod, factor;
+        };
+
+        const Contender contenders[] = { { "bilinear", BilinearDesign, 1 },
+                                         { "matched", MatchedDesign, 1 },
+                                         { "bilinear2x", BilinearDesign, 2 },
+                                         { "bilinear4x", BilinearDesign, 4 },
+                                         { "bilinear8x", BilinearDesign, 8 } };
+
+        auto addErrors = [&](juce::DynamicObject* result, const ChainSettings& settings, int stages, double sampleRate)
+        {
+            for (const auto& contender : contenders)
+                result->setProperty(juce::String(contender.name) + "MaxErrorDecibels",
+                                    measureDesignError(settings, stages, contender.designMethod, contender.factor, sampleRate));
+        };
+
+        for (auto sampleRate : { 44100.0, 48000.0 })
+        {
+            for (auto filterType : { PeakFilter, NotchFilter, BandPassFilter })
+                for (auto frequency : { 1000.f, 10000.f, 15000.f, 18000.f })
+                {
+                    std::cerr << "matched design " << getFilterTypeName(filterType) << " " << frequency
+                              << " Hz at " << sampleRate << " Hz" << std::endl;
+
+                    ChainSettings settings;
+                    settings.filterName[0] = filterType;
+                    settings.bandEnabled[0] = true;
+                    settings.peakFreq[0] = frequency;
+                    settings.peakQuality[0] = 2.f;
+                    settings.peakGainInDecibels[0] = 12.f;
+
+                    auto* result = results.add("matchedDesignAccuracy");
+                    result->setProperty("stage", getFilterTypeName(filterType));
+                    result->setProperty("frequency", frequency);
+                    result->setProperty("sampleRate", sampleRate);
+                    addErrors(result, settings, getBandDirtyBit(0), sampleRate);
+                }
+
+            for (auto frequency : { 5000.f, 10000.f, 16000.f })
+            {
+                std::cerr << "matched design HighCut " << frequency << " Hz at " << sampleRate << " Hz" << std::endl;
+
+                ChainSettings settings;
+                settings.highCutFreq = frequency;
+                settings.highCutSlope = Slope_24;
+
+                auto* result = results.add("matchedDesignAccuracy");
+                result->setProperty("stage", "HighCut");
+                result->setProperty("frequency", frequency);
+                result->setProperty("sampleRate", sampleRate);
+                addErrors(result, settings, HighCutDirty, sampleRate);
+            }
+        }
+
+        double sink = 0.0;
+
+        for (auto designMethod : { BilinearDesign, MatchedDesign })
+            for (auto filterType : { PeakFilter, NotchFilter, BandPassFilter })
+            {
+                std::cerr << "design cost " << (designMethod == MatchedDesign ? "matched " : "bilinear ")
+                          << getFilterTypeName(filterType) << std::endl;
+
+                ChainCoefficients coefficients;
+
+                auto* result = results.add("matchedDesignCost");
+                result->setProperty("designMethod", designMethod == MatchedDesign ? "matched" : "bilinear");
+                result->setProperty("filterType", getFilterTypeName(filterType));
+                result->setProperty("nsPerCall", measureNanosecondsPerCall(iterations, [&](int i)
+                {
+                    auto settings = makeSettings(i, Slope_24, filterType);
+                    settings.designMethod = designMethod;
+                    calculateChainCoefficients(coefficients, settings, 48000.0, AllStagesDirty);
+                    sink += coefficients.bands[0].b0;
+                }));
+            }
+
+        // Keeps the optimiser from discarding the designs.
+        if (sink == 0.123)
+            std::cerr << sink << std::endl;
+    }
+
+    // Cost of the designer's cached designs for the first of many instances
+    // on the same settings, which designs them, against the others, which
+    // find them in the process-wide cache.
+    void benchmarkSharedCoefficientCache(Results& results)
+    {
+        constexpr int numInstances = 32;
+        constexpr int numSettings = 1000;
+
+        std::cerr << "shared coefficient cache, " << numInstances << " instances" << std::endl;
+
+        std::vector<ChainSettings> settings;
+
+        for (int i = 0; i < numSettings; ++i)
+        {
+            auto chainSettings = makeSettings(i, slopes[i % 4], PeakFilter);
+            chainSettings.lowCutFreq = 20.f + static_cast<float>(i % 400);
+            settings.push_back(chainSettings);
+        }
+
+        std::vector<double> firstInstance, otherInstances;
+        double sink = 0.0;
+
+        for (int repetition = 0; repetition < numRepetitions; ++repetition)
+        {
+            // A rate nothing else in the process has used, so the shared
+            // tables start without these designs.
+            auto sampleRate = 48000.0 + 0.5 * (repetition + 1);
+
+            std::vector<std::unique_ptr<CoefficientCache>> caches;
+            ChainCoefficients coefficients;
+            juce::int64 otherTicks = 0;
+
+            for (int instance = 0; instance < numInstances; ++instance)
+            {
+                caches.push_back(std::make_unique<CoefficientCache>());
+                caches.back()->setSampleRate(sampleRate);
+
+                auto start = juce::Time::getHighResolutionTicks();
+
+                for (const auto& chainSettings : settings)
+                {
+                    caches.back()->design(coefficients, chainSettings, AllStagesDirty);
+                    sink += coefficients.lowCut.sections[0].b0;
+                }
+
+                auto ticks = juce::Time::getHighResolutionTicks() - start;
+
+                if (instance == 0)
+                    firstInstance.push_back(juce::Time::highResolutionTicksToSeconds(ticks) * 1.0e9 / numSettings);
+                else
+                    otherTicks += ticks;
+            }
+
+            otherInstances.push_back(juce::Time::highResolutionTicksToSeconds(otherTicks) * 1.0e9 / (numSettings * (numInstances - 1)));
+        }
+
+        auto* result = results.add("sharedCoefficientCache");
+        result->setProperty("numInstances", numInstances);
+        result->setProperty("numSettings", numSettings);
+        result->setProperty("firstInstanceNsPerDesign", median(firstInstance));
+        result->setProperty("otherInstancesNsPerDesign", median(otherInstances));
+
+        // Keeps the optimiser from discarding the designs.
+        if (sink == 0.123)
+            std::cerr << sink << std::endl;
+    }
+
+    // Cost of setStateInformation() in the binary format against the older
+    // ValueTree stream, restoring the state already loaded and alternating
+    // between two presets as a preset browser does.
+    void benchmarkStateLoad(Results& results)
+    {
+        constexpr int iterations = 2000;
+
+        Project_EEAVAudioProcessor processor;
+
+        auto savePreset = [&processor](bool binary)
+        {
+            juce::MemoryBlock state;
+
+            if (binary)
+            {
+                processor.getStateInformation(state);
+            }
+            else
+            {
+                juce::MemoryOutputStream stream(state, false);
+                processor.apvts.copyState().writeToStream(stream);
+            }
+
+            return state;
+        };
+
+        setParameter(processor, "LowCut Freq", 80.f);
+        setParameter(processor, "LowCut Slope", static_cast<float>(Slope_24));
+        setParameter(processor, "Peak Gain", 3.f);
+        std::array<juce::MemoryBlock, 2> firstPreset{ { savePreset(false), savePreset(true) } };
+
+        setParameter(processor, "LowCut Freq", 120.f);
+        setParameter(processor, "HighCut Freq", 9000.f);
+        setParameter(processor, "Peak Freq", 2500.f);
+        setParameter(processor, "Peak Gain", -4.5f);
+        setParameter(processor, getBandParameterID("Peak On", 1), 1.f);
+        setParameter(processor, getBandParameterID("Peak Gain", 1), 6.f);
+        std::array<juce::MemoryBlock, 2> secondPreset{ { savePreset(false), savePreset(true) } };
+
+        for (auto binary : { false, true })
+            for (auto alternate : { false, true })
+            {
+                const auto& first = firstPreset[binary ? 1 : 0];
+                const auto& second = secondPreset[binary ? 1 : 0];
+
+                std::cerr << "state load " << (binary ? "binary " : "ValueTree ")
+                          << (alternate ? "alternating" : "unchanged") << std::endl;
+
+                auto* result = results.add("stateLoad");
+                result->setProperty("format", binary ? "binary" : "ValueTree");
+                result->setProperty("scenario", alternate ? "alternating" : "unchanged");
+                result->setProperty("stateBytes", static_cast<int>(first.getSize()));
+                result->setProperty("nsPerLoad", measureNanosecondsPerCall(iterations, [&](int i)
+                {
+                    const auto& state = alternate && i % 2 == 1 ? second : first;
+                    processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+                }));
+            }
+    }
+
+    void benchmarkResponseCurve(Results& results)
+    {
+        constexpr double sampleRate = 48000.0;
+        constexpr int iterations = 500;
+
+        for (auto slope : slopes)
+        {
+            std::cerr << "response curve " << getSlopeInDecibelsPerOctave(slope) << " dB/oct" << std::endl;
+
+            // What the editor does when a parameter changes.
+            ResponseCurve curve;
+            curve.setSize(responseCurveWidth, sampleRate);
+
+            ChainCoefficients coefficients;
+
+            auto nsPerCall = measureNanosecondsPerCall(iterations, [&](int i)
+            {
+                calculateChainCoefficients(coefficients, makeSettings(i, slope, PeakFilter), sampleRate, AllStagesDirty);
+                curve.update(coefficients);
+            });
+
+            auto* result = results.add("responseCurve");
+            result->setProperty("slope", getSlopeInDecibelsPerOctave(slope));
+            result->setProperty("width", responseCurveWidth);
+            result->setProperty("nsPerCall", nsPerCall);
+            result->setProperty("nsPerPixel", nsPerCall / responseCurveWidth);
+        }
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::File outputFile;
+
+    for (int i = 1; i + 1 < argc; ++i)
+        if (juce::String(argv[i]) == "--output")
+            outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(juce::String(argv[i + 1]));
+
+    Results results;
+
+    benchmarkFilterDesign(results);
+    benchmarkMatchedDesign(results);
+    benchmarkSharedCoefficientCache(results);
+    benchmarkStateLoad(results);
+    benchmarkResponseCurve(results);
+    benchmarkSmoothingUpdateInterval(results);
+    benchmarkOversampling(results);
+    benchmarkChannelCount(results);
+    benchmarkStereoMode(results);
+    benchmarkBandCount(results);
+    benchmarkPrecision(results);
+    benchmarkSilence(results);
+    benchmarkParameterEvents(results);
+    benchmarkMorph(results);
+    benchmarkDynamicBand(results);
+    benchmarkProcessBlock(results);
+
+    auto json = results.toJSON();
+
+    if (outputFile == juce::File())
+    {
+        std::cout << json << std::endl;
+    }
+    else if (!outputFile.replaceWithText(json))
+    {
+        std::cerr << "Cannot write " << outputFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
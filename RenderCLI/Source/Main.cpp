@@ -0,0 +1,353 @@
+/*
+  ==============================================================================
+
+    Headless offline renderer for Project_EEAVAudioProcessor.
+
+    Streams WAV / FLAC files through the plugin's processBlock with a given
+    preset and writes the results, one processor instance per worker thread.
+
+    EEAVRender --state <preset> --out <directory> [--threads <n>] [--block <n>]
+               <file or directory>...
+
+    The preset can be a getStateInformation blob or the same state as XML.
+    Outputs are compensated for the plugin's latency: aligned with their
+    inputs and just as long.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+
+#include "../../Source/PluginProcessor.h"
+
+namespace
+{
+    constexpr int defaultBlockSize = 8192;
+
+    struct RenderSettings
+    {
+        juce::File stateFile, outputDirectory;
+        int numThreads{ juce::SystemStats::getNumCpus() };
+        int blockSize{ defaultBlockSize };
+        juce::Array<juce::File> inputs;
+    };
+
+    struct RenderResult
+    {
+        double secondsOfAudio{ 0.0 }, secondsTaken{ 0.0 };
+        juce::String error;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: EEAVRender --state <preset> --out <directory> [--threads <n>] [--block <n>]"
+                     " <file or directory>..." << std::endl;
+    }
+
+    // Returns an error message, or an empty string on success.
+    juce::String parseArguments(const juce::StringArray& arguments, RenderSettings& settings)
+    {
+        for (int i = 0; i < arguments.size(); ++i)
+        {
+            const auto& argument = arguments[i];
+
+            if (argument.startsWith("--"))
+            {
+                if (i + 1 >= arguments.size())
+                    return "Missing value for " + argument;
+
+                const auto& value = arguments[++i];
+
+                if (argument == "--state")
+                    settings.stateFile = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+                else if (argument == "--out")
+                    settings.outputDirectory = juce::File::getCurrentWorkingDirectory().getChildFile(value);
+                else if (argument == "--threads")
+                    settings.numThreads = juce::jmax(1, value.getIntValue());
+                else if (argument == "--block")
+                    settings.blockSize = juce::jmax(1, value.getIntValue());
+                else
+                    return "Unknown option " + argument;
+
+                continue;
+            }
+
+            auto input = juce::File::getCurrentWorkingDirectory().getChildFile(argument);
+
+            if (input.isDirectory())
+                settings.inputs.addArray(input.findChildFiles(juce::File::findFiles, true, "*.wav;*.flac"));
+            else if (input.existsAsFile())
+                settings.inputs.add(input);
+            else
+                return "No such file or directory: " + argument;
+        }
+
+        if (settings.stateFile == juce::File() || !settings.stateFile.existsAsFile())
+            return "A readable --state preset is required";
+
+        if (settings.outputDirectory == juce::File())
+            return "An --out directory is required";
+
+        if (settings.inputs.isEmpty())
+            return "No input files";
+
+        return {};
+    }
+
+    // Accepts both a raw getStateInformation blob and its XML form.
+    juce::MemoryBlock loadState(const juce::File& stateFile)
+    {
+        juce::MemoryBlock state;
+        stateFile.loadFileAsData(state);
+
+        if (auto xml = juce::parseXML(state.toString()))
+        {
+            juce::MemoryBlock converted;
+            juce::MemoryOutputStream mos(converted, false);
+            juce::ValueTree::fromXml(*xml).writeToStream(mos);
+            mos.flush();
+
+            return converted;
+        }
+
+        return state;
+    }
+
+    RenderResult renderFile(Project_EEAVAudioProcessor& processor,
+                            juce::AudioFormatManager& formatManager,
+                            const juce::File& input,
+                            const juce::File& outputDirectory,
+                            int blockSize)
+    {
+        RenderResult result;
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        std::unique_ptr<juce::AudioFormatReader> reader(formatManager.createReaderFor(input));
+
+        if (reader == nullptr)
+        {
+            result.error = "Unreadable audio file";
+            return result;
+        }
+
+        auto numChannels = static_cast<int>(reader->numChannels);
+
+        if (numChannels < 1 || numChannels > Project_EEAVAudioProcessor::maxChannels)
+        {
+            result.error = "Only files with 1 to " + juce::String(Project_EEAVAudioProcessor::maxChannels) + " channels are supported";
+            return result;
+        }
+
+        auto output = outputDirectory.getChildFile(input.getFileName());
+
+        if (output == input)
+        {
+            result.error = "Refusing to overwrite the input file";
+            return result;
+        }
+
+        auto* format = formatManager.findFormatForFileExtension(input.getFileExtension());
+        output.deleteFile();
+        auto stream = std::make_unique<juce::FileOutputStream>(output);
+
+        if (format == nullptr || stream->failedToOpen())
+        {
+            result.error = "Cannot create " + output.getFullPathName();
+            return result;
+        }
+
+        std::unique_ptr<juce::AudioFormatWriter> writer(format->createWriterFor(stream.get(),
+                                                                                reader->sampleRate,
+                                                                                reader->numChannels,
+                                                                                static_cast<int>(reader->bitsPerSample),
+                                                                                reader->metadataValues,
+                                                                                0));
+
+        if (writer == nullptr)
+        {
+            result.error = "Unsupported output format";
+            return result;
+        }
+
+        stream.release(); // Now owned by the writer
+
+        processor.setPlayConfigDetails(numChannels, numChannels, reader->sampleRate, blockSize);
+        processor.prepareToPlay(reader->sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer(numChannels, blockSize);
+        juce::MidiBuffer midi;
+
+        // The output is delayed by the plugin's latency (the linear phase
+        // kernel, or the oversampling filters), so that many samples are
+        // dropped from the start and the input is padded with as many zeros
+        // to flush the tail out. The file comes out aligned and full length.
+        auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+        auto lengthToProcess = reader->lengthInSamples + latency;
+        auto samplesToDrop = latency;
+
+        for (juce::int64 position = 0; position < lengthToProcess; position += blockSize)
+        {
+            auto numSamples = static_cast<int>(juce::jmin(static_cast<juce::int64>(blockSize),
+                                                          lengthToProcess - position));
+
+            // Refers to the same memory, so the final partial block doesn't reallocate.
+            juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+            auto numSamplesToRead = static_cast<int>(juce::jlimit(static_cast<juce::int64>(0),
+                                                                  static_cast<juce::int64>(numSamples),
+                                                                  reader->lengthInSamples - position));
+
+            if (numSamplesToRead > 0)
+                reader->read(&block, 0, numSamplesToRead, position, true, true);
+
+            if (numSamplesToRead < numSamples)
+                block.clear(numSamplesToRead, numSamples - numSamplesToRead);
+
+            processor.processBlock(block, midi);
+
+            auto numSamplesToDrop = static_cast<int>(juce::jmin(samplesToDrop, static_cast<juce::int64>(numSamples)));
+            samplesToDrop -= numSamplesToDrop;
+
+            if (numSamplesToDrop < numSamples
+                && !writer->writeFromAudioSampleBuffer(block, numSamplesToDrop, numSamples - numSamplesToDrop))
+            {
+                result.error = "Write failed";
+                break;
+            }
+        }
+
+        processor.releaseResources();
+        writer.reset();
+
+        result.secondsOfAudio = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+        result.secondsTaken = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+        return result;
+    }
+
+    // Owns one processor and renders whichever file is next in the queue
+    // until there are none left.
+    class RenderWorker : public juce::Thread
+    {
+    public:
+        RenderWorker(const RenderSettings& s,
+                     const juce::MemoryBlock& state,
+                     std::atomic<int>& next,
+                     std::vector<RenderResult>& r)
+            : juce::Thread("EEAV render worker"), settings(s), nextInput(next), results(r)
+        {
+            // Processors are created here, on the main thread, and then only
+            // ever used by this worker.
+            processor.setNonRealtime(true);
+            processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+
+            formatManager.registerBasicFormats();
+        }
+
+        void run() override
+        {
+            for (;;)
+            {
+                auto index = nextInput.fetch_add(1);
+
+                if (index >= settings.inputs.size() || threadShouldExit())
+                    return;
+
+                results[static_cast<size_t>(index)] = renderFile(processor,
+                                                                 formatManager,
+                                                                 settings.inputs.getReference(index),
+                                                                 settings.outputDirectory,
+                                                                 settings.blockSize);
+            }
+        }
+
+    private:
+        const RenderSettings& settings;
+        std::atomic<int>& nextInput;
+        std::vector<RenderResult>& results;
+
+        Project_EEAVAudioProcessor processor;
+        juce::AudioFormatManager formatManager;
+    };
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::StringArray arguments;
+
+    for (int i = 1; i < argc; ++i)
+        arguments.add(juce::CharPointer_UTF8(argv[i]));
+
+    if (arguments.isEmpty() || arguments.contains("--help"))
+    {
+        printUsage();
+        return arguments.isEmpty() ? 1 : 0;
+    }
+
+    RenderSettings settings;
+    auto error = parseArguments(arguments, settings);
+
+    if (error.isNotEmpty())
+    {
+        std::cerr << error << std::endl;
+        printUsage();
+        return 1;
+    }
+
+    if (!settings.outputDirectory.createDirectory())
+    {
+        std::cerr << "Cannot create " << settings.outputDirectory.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    auto state = loadState(settings.stateFile);
+
+    std::vector<RenderResult> results(static_cast<size_t>(settings.inputs.size()));
+    std::atomic<int> nextInput{ 0 };
+
+    auto numWorkers = juce::jmin(settings.numThreads, settings.inputs.size());
+    std::vector<std::unique_ptr<RenderWorker>> workers;
+
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<RenderWorker>(settings, state, nextInput, results));
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (auto& worker : workers)
+        worker->startThread();
+
+    for (auto& worker : workers)
+        worker->waitForThreadToExit(-1);
+
+    auto wallSeconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - startTicks);
+
+    double totalSecondsOfAudio = 0.0;
+    int numFailed = 0;
+
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const auto& result = results[i];
+        auto name = settings.inputs.getReference(static_cast<int>(i)).getFileName();
+
+        if (result.error.isNotEmpty())
+        {
+            std::cerr << name << ": " << result.error << std::endl;
+            ++numFailed;
+            continue;
+        }
+
+        totalSecondsOfAudio += result.secondsOfAudio;
+
+        std::cout << name << ": "
+                  << juce::String(result.secondsOfAudio / juce::jmax(result.secondsTaken, 1.0e-9), 1)
+                  << "x realtime" << std::endl;
+    }
+
+    std::cout << "Rendered " << (results.size() - static_cast<size_t>(numFailed)) << " of " << results.size()
+              << " files on " << numWorkers << " threads: "
+              << juce::String(totalSecondsOfAudio / juce::jmax(wallSeconds, 1.0e-9), 1)
+              << "x realtime overall" << std::endl;
+
+    return numFailed == 0 ? 0 : 1;
+}
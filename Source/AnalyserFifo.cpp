@@ -0,0 +1,82 @@
+/*
+  ==============================================================================
+
+    AnalyserFifo.cpp
+    Wait-free audio -> GUI sample queue for the spectrum analyser.
+
+  ==============================================================================
+*/
+
+#include "AnalyserFifo.h"
+
+void AnalyserFifo::mixDown(const juce::dsp::AudioBlock<const float>& block, size_t offset, float* destination, int numSamples) noexcept
+{
+    auto numChannels = block.getNumChannels();
+    auto gain = 1.f / static_cast<float>(numChannels);
+
+    juce::FloatVectorOperations::copyWithMultiply(destination, block.getChannelPointer(0) + offset, gain, numSamples);
+
+    for (size_t channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply(destination, block.getChannelPointer(channel) + offset, gain, numSamples);
+}
+
+void AnalyserFifo::mixDown(const juce::dsp::AudioBlock<const double>& block, size_t offset, float* destination, int numSamples) noexcept
+{
+    // The display only needs float, so the mix is rounded as it is written.
+    auto numChannels = block.getNumChannels();
+    auto gain = 1.0 / static_cast<double>(numChannels);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto sum = 0.0;
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+            sum += block.getChannelPointer(channel)[offset + static_cast<size_t>(i)];
+
+        destination[i] = static_cast<float>(sum * gain);
+    }
+}
+
+void AnalyserFifo::push(const juce::dsp::AudioBlock<const float>& block) noexcept
+{
+    pushBlock(block);
+}
+
+void AnalyserFifo::push(const juce::dsp::AudioBlock<const double>& block) noexcept
+{
+    pushBlock(block);
+}
+
+template <typename SampleType>
+void AnalyserFifo::pushBlock(const juce::dsp::AudioBlock<const SampleType>& block) noexcept
+{
+    if (block.getNumChannels() == 0)
+        return;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite(static_cast<int>(block.getNumSamples()), start1, size1, start2, size2);
+
+    if (size1 > 0)
+        mixDown(block, 0, buffer.data() + start1, size1);
+
+    if (size2 > 0)
+        mixDown(block, static_cast<size_t>(size1), buffer.data() + start2, size2);
+
+    fifo.finishedWrite(size1 + size2);
+}
+
+int AnalyserFifo::pull(float* destination, int maxSamples) noexcept
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+    if (size1 > 0)
+        std::copy_n(buffer.data() + start1, size1, destination);
+
+    if (size2 > 0)
+        std::copy_n(buffer.data() + start2, size2, destination + size1);
+
+    fifo.finishedRead(size1 + size2);
+
+    return size1 + size2;
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    AnalyserFifo.h
+    Wait-free audio -> GUI sample queue for the spectrum analyser.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Single producer (audio thread), single consumer (message thread) queue of
+    mono samples, built on juce::AbstractFifo.
+
+    The storage is allocated once, in the constructor, and never resized, so
+    neither side ever allocates or waits on the other. If the consumer falls
+    behind, the samples that don't fit are dropped.
+*/
+class AnalyserFifo
+{
+public:
+    // About 170 ms at 192 kHz, several GUI frames' worth.
+    static constexpr int capacity = 1 << 15;
+
+    AnalyserFifo() : buffer(static_cast<size_t>(capacity), 0.f) {}
+
+    // Audio thread. Pushes the average of the block's channels.
+    void push(const juce::dsp::AudioBlock<const float>& block) noexcept;
+    void push(const juce::dsp::AudioBlock<const double>& block) noexcept;
+
+    // Message thread. Returns the number of samples copied to `destination`.
+    int pull(float* destination, int maxSamples) noexcept;
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::vector<float> buffer;
+
+    template <typename SampleType>
+    void pushBlock(const juce::dsp::AudioBlock<const SampleType>& block) noexcept;
+
+    void mixDown(const juce::dsp::AudioBlock<const float>& block, size_t offset, float* destination, int numSamples) noexcept;
+    void mixDown(const juce::dsp::AudioBlock<const double>& block, size_t offset, float* destination, int numSamples) noexcept;
+};
@@ -0,0 +1,186 @@
+/*
+  ==============================================================================
+
+    BinaryState.cpp
+    Compact, versioned binary form of the plugin's state.
+
+  ==============================================================================
+*/
+
+#include "BinaryState.h"
+
+namespace
+{
+    constexpr int headerSize = 3 * sizeof(int);
+
+    // Each field of the settings as a float, in the order they are stored.
+    constexpr int floatsPerChainSettings = 4 + 5 * maxBands;
+
+    juce::RangedAudioParameter& toRanged(juce::AudioProcessorParameter* parameter) noexcept
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+        jassert(ranged != nullptr);
+        return *ranged;
+    }
+
+    void writeChainSettings(juce::OutputStream& stream, const ChainSettings& settings)
+    {
+        stream.writeFloat(settings.lowCutFreq);
+        stream.writeFloat(settings.highCutFreq);
+        stream.writeFloat(static_cast<float>(settings.lowCutSlope));
+        stream.writeFloat(static_cast<float>(settings.highCutSlope));
+
+        for (int band = 0; band < maxBands; ++band)
+        {
+            stream.writeFloat(settings.peakFreq[band]);
+            stream.writeFloat(settings.peakGainInDecibels[band]);
+            stream.writeFloat(settings.peakQuality[band]);
+            stream.writeFloat(static_cast<float>(settings.filterName[band]));
+            stream.writeFloat(settings.bandEnabled[band] ? 1.f : 0.f);
+        }
+    }
+
+    ChainSettings readChainSettings(juce::InputStream& stream)
+    {
+        ChainSettings settings;
+
+        settings.lowCutFreq = stream.readFloat();
+        settings.highCutFreq = stream.readFloat();
+        settings.lowCutSlope = juce::jlimit(0, static_cast<int>(Slope_48), static_cast<int>(stream.readFloat()));
+        settings.highCutSlope = juce::jlimit(0, static_cast<int>(Slope_48), static_cast<int>(stream.readFloat()));
+
+        for (int band = 0; band < maxBands; ++band)
+        {
+            settings.peakFreq[band] = stream.readFloat();
+            settings.peakGainInDecibels[band] = stream.readFloat();
+            settings.peakQuality[band] = stream.readFloat();
+            settings.filterName[band] = juce::jlimit(0, static_cast<int>(BandPassFilter), static_cast<int>(stream.readFloat()));
+            settings.bandEnabled[band] = stream.readFloat() > 0.5f;
+        }
+
+        return settings;
+    }
+
+    // Returns false if the stream ends before the snapshots do.
+    bool readSnapshots(juce::InputStream& stream, SnapshotBank& snapshots)
+    {
+        constexpr auto snapshotSize = static_cast<juce::int64>(numChainPaths * floatsPerChainSettings * sizeof(float));
+
+        if (stream.getNumBytesRemaining() < static_cast<juce::int64>(sizeof(int)))
+            return false;
+
+        auto numStored = stream.readInt();
+
+        for (int slot = 0; slot < numStored; ++slot)
+        {
+            if (stream.getNumBytesRemaining() < static_cast<juce::int64>(sizeof(int)))
+                return false;
+
+            std::optional<ChainSnapshot> snapshot;
+
+            if (stream.readInt() != 0)
+            {
+                if (stream.getNumBytesRemaining() < snapshotSize)
+                    return false;
+
+                snapshot.emplace();
+
+                for (auto& settings : *snapshot)
+                    settings = readChainSettings(stream);
+            }
+
+            // Slots beyond this build's are dropped.
+            if (slot < numSnapshots)
+                snapshots[static_cast<size_t>(slot)] = snapshot;
+        }
+
+        return true;
+    }
+}
+
+bool isBinaryState(const void* data, int sizeInBytes) noexcept
+{
+    return data != nullptr
+        && sizeInBytes >= headerSize
+        && juce::ByteOrder::littleEndianInt(data) == static_cast<juce::uint32>(binaryStateMagic);
+}
+
+void writeBinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters,
+    const SnapshotBank& snapshots,
+    juce::MemoryBlock& destination)
+{
+    destination.setSize(0);
+    juce::MemoryOutputStream stream(destination, false);
+
+    stream.writeInt(binaryStateMagic);
+    stream.writeInt(binaryStateVersion);
+    stream.writeInt(parameters.size());
+
+    for (auto* parameter : parameters)
+    {
+        auto& ranged = toRanged(parameter);
+        stream.writeFloat(ranged.convertFrom0to1(ranged.getValue()));
+    }
+
+    stream.writeInt(numSnapshots);
+
+    for (const auto& snapshot : snapshots)
+    {
+        stream.writeInt(snapshot.has_value() ? 1 : 0);
+
+        if (snapshot.has_value())
+            for (const auto& settings : *snapshot)
+                writeChainSettings(stream, settings);
+    }
+}
+
+int restoreBinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters,
+    SnapshotBank& snapshots,
+    const void* data,
+    int sizeInBytes)
+{
+    if (!isBinaryState(data, sizeInBytes))
+        return -1;
+
+    juce::MemoryInputStream stream(data, static_cast<size_t>(sizeInBytes), false);
+    stream.readInt(); // Magic
+
+    auto version = stream.readInt();
+    auto numValues = stream.readInt();
+
+    if (version < 1 || version > binaryStateVersion || numValues < 0
+        || stream.getNumBytesRemaining() < static_cast<juce::int64>(numValues) * static_cast<juce::int64>(sizeof(float)))
+        return -1;
+
+    // The values are read up front so a truncated snapshot block rejects the
+    // state before any parameter has changed.
+    std::vector<float> values(static_cast<size_t>(numValues));
+
+    for (auto& value : values)
+        value = stream.readFloat();
+
+    SnapshotBank restoredSnapshots;
+
+    if (version >= 2 && !readSnapshots(stream, restoredSnapshots))
+        return -1;
+
+    snapshots = restoredSnapshots;
+
+    int numChanged = 0;
+
+    for (int i = 0; i < parameters.size(); ++i)
+    {
+        auto& ranged = toRanged(parameters.getUnchecked(i));
+
+        // Values past the end of an older state's block are at their defaults.
+        auto normalised = i < numValues ? ranged.convertTo0to1(values[static_cast<size_t>(i)]) : ranged.getDefaultValue();
+
+        if (normalised != ranged.getValue())
+        {
+            ranged.setValueNotifyingHost(normalised);
+            ++numChanged;
+        }
+    }
+
+    return numChanged;
+}
@@ -0,0 +1,52 @@
+/*
+  ==============================================================================
+
+    BinaryState.h
+    Compact, versioned binary form of the plugin's state.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "MorphEngine.h"
+
+/**
+    The state is a 12 byte header followed by one fixed-layout parameter
+    block: every parameter's value, in its own range (what ChainSettings
+    holds), as a little endian float, in getParameters() order. Reading it
+    needs no tree parsing and no ID lookups.
+
+    The block relies on createParameterLayout() only ever appending
+    parameters. A state from an older build simply has fewer values, and the
+    parameters it doesn't cover are restored to their defaults. A change that
+    reorders or removes parameters must bump binaryStateVersion.
+
+    From version 2 the snapshot slots follow: their count, then for each a
+    stored flag and, if set, both paths' ChainSettings as a fixed sequence
+    of floats. Version 1 states have no snapshots.
+
+    States written before this format are ValueTree streams, which never
+    start with binaryStateMagic.
+*/
+constexpr int binaryStateMagic = 0x56414545; // "EEAV" in little endian
+constexpr int binaryStateVersion = 2;
+
+bool isBinaryState(const void* data, int sizeInBytes) noexcept;
+
+// All the parameters must be RangedAudioParameters, as an APVTS's are.
+void writeBinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters,
+    const SnapshotBank& snapshots,
+    juce::MemoryBlock& destination);
+
+// Sets only the parameters whose value differs from the state's, so the
+// listeners, and through them the coefficient designers, only hear about
+// what changed, and replaces `snapshots` with the state's. Returns the
+// number of parameters changed, or -1 if the data isn't a binary state this
+// version can read, in which case nothing is touched.
+int restoreBinaryState(const juce::Array<juce::AudioProcessorParameter*>& parameters,
+    SnapshotBank& snapshots,
+    const void* data,
+    int sizeInBytes);
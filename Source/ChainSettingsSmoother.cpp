@@ -0,0 +1,152 @@
+/*
+  ==============================================================================
+
+    ChainSettingsSmoother.cpp
+    Ramps the continuous ChainSettings values towards their parameter targets.
+
+  ==============================================================================
+*/
+
+#include "ChainSettingsSmoother.h"
+
+void ChainSettingsSmoother::reset(double sampleRate, double rampLengthSeconds) noexcept
+{
+    lowCutFreq.reset(sampleRate, rampLengthSeconds);
+    highCutFreq.reset(sampleRate, rampLengthSeconds);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        peakFreq[band].reset(sampleRate, rampLengthSeconds);
+        peakQuality[band].reset(sampleRate, rampLengthSeconds);
+        peakGain[band].reset(sampleRate, rampLengthSeconds);
+    }
+}
+
+void ChainSettingsSmoother::setCurrentAndTarget(const ChainSettings& chainSettings) noexcept
+{
+    current = chainSettings;
+
+    lowCutFreq.setCurrentAndTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setCurrentAndTargetValue(chainSettings.highCutFreq);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        peakFreq[band].setCurrentAndTargetValue(chainSettings.peakFreq[band]);
+        peakQuality[band].setCurrentAndTargetValue(chainSettings.peakQuality[band]);
+        peakGain[band].setCurrentAndTargetValue(chainSettings.peakGainInDecibels[band]);
+    }
+
+    pendingStages = AllStagesDirty;
+}
+
+void ChainSettingsSmoother::setTarget(const ChainSettings& chainSettings) noexcept
+{
+    lowCutFreq.setTargetValue(chainSettings.lowCutFreq);
+    highCutFreq.setTargetValue(chainSettings.highCutFreq);
+
+    if (chainSettings.lowCutSlope != current.lowCutSlope)
+    {
+        current.lowCutSlope = chainSettings.lowCutSlope;
+        pendingStages |= LowCutDirty;
+    }
+
+    if (chainSettings.highCutSlope != current.highCutSlope)
+    {
+        current.highCutSlope = chainSettings.highCutSlope;
+        pendingStages |= HighCutDirty;
+    }
+
+    if (chainSettings.designMethod != current.designMethod)
+    {
+        current.designMethod = chainSettings.designMethod;
+        pendingStages |= AllStagesDirty;
+    }
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (chainSettings.bandEnabled[band] != current.bandEnabled[band])
+        {
+            // A band switched on starts at its target: there is nothing
+            // sensible to ramp from.
+            current.bandEnabled[band] = chainSettings.bandEnabled[band];
+            current.peakFreq[band] = chainSettings.peakFreq[band];
+            current.peakQuality[band] = chainSettings.peakQuality[band];
+            current.peakGainInDecibels[band] = chainSettings.peakGainInDecibels[band];
+
+            peakFreq[band].setCurrentAndTargetValue(chainSettings.peakFreq[band]);
+            peakQuality[band].setCurrentAndTargetValue(chainSettings.peakQuality[band]);
+            peakGain[band].setCurrentAndTargetValue(chainSettings.peakGainInDecibels[band]);
+
+            pendingStages |= getBandDirtyBit(band);
+        }
+
+        if (!current.bandEnabled[band])
+            continue;
+
+        peakFreq[band].setTargetValue(chainSettings.peakFreq[band]);
+        peakQuality[band].setTargetValue(chainSettings.peakQuality[band]);
+        peakGain[band].setTargetValue(chainSettings.peakGainInDecibels[band]);
+
+        if (chainSettings.filterName[band] != current.filterName[band])
+        {
+            current.filterName[band] = chainSettings.filterName[band];
+            pendingStages |= getBandDirtyBit(band);
+        }
+    }
+}
+
+bool ChainSettingsSmoother::isSmoothing() const noexcept
+{
+    if (pendingStages != 0 || lowCutFreq.isSmoothing() || highCutFreq.isSmoothing())
+        return true;
+
+    for (int band = 0; band < maxBands; ++band)
+        if (current.bandEnabled[band]
+            && (peakFreq[band].isSmoothing() || peakQuality[band].isSmoothing() || peakGain[band].isSmoothing()))
+            return true;
+
+    return false;
+}
+
+int ChainSettingsSmoother::advance(int numSamples) noexcept
+{
+    auto stages = std::exchange(pendingStages, 0);
+
+    if (lowCutFreq.isSmoothing())
+    {
+        current.lowCutFreq = lowCutFreq.skip(numSamples);
+        stages |= LowCutDirty;
+    }
+
+    if (highCutFreq.isSmoothing())
+    {
+        current.highCutFreq = highCutFreq.skip(numSamples);
+        stages |= HighCutDirty;
+    }
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (!current.bandEnabled[band])
+            continue;
+
+        if (peakFreq[band].isSmoothing())
+        {
+            current.peakFreq[band] = peakFreq[band].skip(numSamples);
+            stages |= getBandDirtyBit(band);
+        }
+
+        if (peakQuality[band].isSmoothing())
+        {
+            current.peakQuality[band] = peakQuality[band].skip(numSamples);
+            stages |= getBandDirtyBit(band);
+        }
+
+        if (peakGain[band].isSmoothing())
+        {
+            current.peakGainInDecibels[band] = peakGain[band].skip(numSamples);
+            stages |= getBandDirtyBit(band);
+        }
+    }
+
+    return stages;
+}
@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    ChainSettingsSmoother.h
+    Ramps the continuous ChainSettings values towards their parameter targets.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    SmoothedValue ramps for every continuous parameter in ChainSettings.
+
+    Frequencies and Q ramp multiplicatively (evenly in octaves), gain ramps
+    linearly in decibels. The slope, filter type and band on/off choices
+    cannot be interpolated, so they jump; the stage they belong to is still
+    reported as changed so its coefficients get recalculated. Disabled bands
+    are not ramped at all.
+
+    Audio thread only.
+*/
+class ChainSettingsSmoother
+{
+public:
+    void reset(double sampleRate, double rampLengthSeconds) noexcept;
+
+    // Jumps straight to `chainSettings` with no ramp.
+    void setCurrentAndTarget(const ChainSettings& chainSettings) noexcept;
+    void setTarget(const ChainSettings& chainSettings) noexcept;
+
+    bool isSmoothing() const noexcept;
+
+    // Moves every ramp `numSamples` forward and returns the DirtyStages whose
+    // settings changed since the previous call.
+    int advance(int numSamples) noexcept;
+
+    const ChainSettings& getCurrent() const noexcept { return current; }
+
+private:
+    using Multiplicative = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative>;
+    using Linear = juce::SmoothedValue<float, juce::ValueSmoothingTypes::Linear>;
+
+    Multiplicative lowCutFreq, highCutFreq;
+    std::array<Multiplicative, maxBands> peakFreq, peakQuality;
+    std::array<Linear, maxBands> peakGain;
+
+    ChainSettings current;
+    int pendingStages{ 0 };
+};
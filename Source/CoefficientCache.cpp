@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.cpp
+    Shared, memoised filter designs for the coefficient designer thread.
+
+  ==============================================================================
+*/
+
+#include "CoefficientCache.h"
+
+namespace
+{
+    // Parameter steps from createParameterLayout()
+    constexpr float frequencyStep = 1.f;
+    constexpr float qualityStep = 0.05f;
+    constexpr float gainStep = 0.5f;
+
+    juce::uint64 toBin(float value, float step, float offset = 0.f) noexcept
+    {
+        return static_cast<juce::uint64>(juce::jmax(0, juce::roundToInt((value - offset) / step)));
+    }
+
+    float fromBin(juce::uint64 bin, float step, float offset = 0.f) noexcept
+    {
+        return static_cast<float>(bin) * step + offset;
+    }
+
+    constexpr float minimumGain = -24.f;
+}
+
+void CoefficientCache::setSampleRate(double newSampleRate)
+{
+    if (newSampleRate != sampleRate)
+    {
+        clear();
+        sampleRate = newSampleRate;
+    }
+}
+
+void CoefficientCache::clear()
+{
+    for (auto& path : references)
+    {
+        path.lowCut.reset();
+        path.highCut.reset();
+
+        for (auto& band : path.bands)
+            band.reset();
+    }
+}
+
+juce::uint64 CoefficientCache::makeCutKey(float frequency, int slope, int designMethod) noexcept
+{
+    return (toBin(frequency, frequencyStep) << 3)
+         | (static_cast<juce::uint64>(designMethod & 1) << 2)
+         | static_cast<juce::uint64>(slope & 3);
+}
+
+juce::uint64 CoefficientCache::makeBandKey(const ChainSettings& chainSettings, int band) noexcept
+{
+    return static_cast<juce::uint64>(chainSettings.filterName[band] & 3)
+         | (toBin(chainSettings.peakFreq[band], frequencyStep) << 2)
+         | (toBin(chainSettings.peakQuality[band], qualityStep) << 22)
+         | (toBin(chainSettings.peakGainInDecibels[band], gainStep, minimumGain) << 42)
+         | (static_cast<juce::uint64>(chainSettings.designMethod & 1) << 50);
+}
+
+template<typename Table, typename DesignFunction>
+auto CoefficientCache::findOrDesign(Table& table, typename Table::Reference& reference, juce::uint64 key, DesignFunction&& designFunction)
+{
+    // Replacing the reference drops the one on the design the stage used before.
+    reference = table.findOrDesign(sampleRate, key, designFunction);
+
+    return reference ? *reference : designFunction();
+}
+
+CutCoefficients CoefficientCache::getLowCut(const ChainSettings& chainSettings, CutReference& reference)
+{
+    auto key = makeCutKey(chainSettings.lowCutFreq, chainSettings.lowCutSlope, chainSettings.designMethod);
+
+    auto design = [&]
+    {
+        auto binned = chainSettings;
+        binned.lowCutFreq = fromBin(key >> 3, frequencyStep);
+        return designLowCutCoefficients(binned, sampleRate);
+    };
+
+    return findOrDesign(sharedCache->lowCuts, reference, key, design);
+}
+
+CutCoefficients CoefficientCache::getHighCut(const ChainSettings& chainSettings, CutReference& reference)
+{
+    auto key = makeCutKey(chainSettings.highCutFreq, chainSettings.highCutSlope, chainSettings.designMethod);
+
+    auto design = [&]
+    {
+        auto binned = chainSettings;
+        binned.highCutFreq = fromBin(key >> 3, frequencyStep);
+        return designHighCutCoefficients(binned, sampleRate);
+    };
+
+    return findOrDesign(sharedCache->highCuts, reference, key, design);
+}
+
+BiquadCoefficients CoefficientCache::getBand(const ChainSettings& chainSettings, int band, BandReference& reference)
+{
+    jassert(chainSettings.bandEnabled[band]);
+
+    auto key = makeBandKey(chainSettings, band);
+
+    auto design = [&]
+    {
+        auto binned = chainSettings;
+        binned.peakFreq[band] = fromBin(toBin(chainSettings.peakFreq[band], frequencyStep), frequencyStep);
+        binned.peakQuality[band] = fromBin(toBin(chainSettings.peakQuality[band], qualityStep), qualityStep);
+        binned.peakGainInDecibels[band] = fromBin(toBin(chainSettings.peakGainInDecibels[band], gainStep, minimumGain), gainStep, minimumGain);
+        return designBandCoefficients(binned, band, sampleRate);
+    };
+
+    return findOrDesign(sharedCache->bands, reference, key, design);
+}
+
+void CoefficientCache::design(ChainCoefficients& destination, const ChainSettings& chainSettings, int stages, int path)
+{
+    jassert(sampleRate > 0.0);
+
+    auto& pathReferences = references[static_cast<size_t>(path)];
+
+    if (stages & LowCutDirty)
+        destination.lowCut = getLowCut(chainSettings, pathReferences.lowCut);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (stages & getBandDirtyBit(band))
+        {
+            auto& reference = pathReferences.bands[static_cast<size_t>(band)];
+
+            if (chainSettings.bandEnabled[band])
+                destination.bands[band] = getBand(chainSettings, band, reference);
+            else
+            {
+                destination.bands[band] = BiquadCoefficients();
+                reference.reset();
+            }
+
+            destination.bandEnabled[band] = chainSettings.bandEnabled[band];
+        }
+    }
+
+    if (stages & HighCutDirty)
+        destination.highCut = getHighCut(chainSettings, pathReferences.highCut);
+}
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    CoefficientCache.h
+    Shared, memoised filter designs for the coefficient designer thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "SharedCoefficientCache.h"
+
+/**
+    Looks every design made by the designer thread up in the process-wide
+    SharedCoefficientCache, so that automation sweeping back and forth over the
+    same values, or many instances on the same settings, cost a hash lookup
+    instead of a Butterworth or RBJ design.
+
+    The cut filters are keyed by (frequency bin, slope) and the parametric
+    bands, which all share one table, by (type, frequency, Q, gain) bins. The bins match the parameter steps
+    (1 Hz, 0.05 Q, 0.5 dB), so every reachable parameter value maps to exactly
+    one entry and is designed at that bin's value.
+
+    The instance keeps no tables of its own, only a reference on each shared
+    design its paths are using. Switching a stage to other settings drops its
+    old reference, so designs no instance uses any more can be recycled. When
+    the shared table has no room, the design is made without caching.
+
+    Not thread safe; owned and used by the designer thread. The shared
+    tables it reads are lock-free.
+*/
+class CoefficientCache
+{
+public:
+    // Drops every reference if the sample rate differs from the one they
+    // were designed for.
+    void setSampleRate(double newSampleRate);
+
+    // Cached equivalent of designChainCoefficients(), for `path`'s coefficients.
+    void design(ChainCoefficients& destination, const ChainSettings& chainSettings, int stages, int path = PathA);
+
+    void clear();
+
+private:
+    using CutReference = SharedDesignTable<CutCoefficients>::Reference;
+    using BandReference = SharedDesignTable<BiquadCoefficients>::Reference;
+
+    // The shared designs a path is using.
+    struct PathReferences
+    {
+        CutReference lowCut, highCut;
+        std::array<BandReference, maxBands> bands;
+    };
+
+    static juce::uint64 makeCutKey(float frequency, int slope, int designMethod) noexcept;
+    static juce::uint64 makeBandKey(const ChainSettings& chainSettings, int band) noexcept;
+
+    // Points `reference` at the shared design, and returns the design.
+    template<typename Table, typename DesignFunction>
+    auto findOrDesign(Table& table, typename Table::Reference& reference, juce::uint64 key, DesignFunction&& designFunction);
+
+    CutCoefficients getLowCut(const ChainSettings& chainSettings, CutReference& reference);
+    CutCoefficients getHighCut(const ChainSettings& chainSettings, CutReference& reference);
+    BiquadCoefficients getBand(const ChainSettings& chainSettings, int band, BandReference& reference);
+
+    double sampleRate{ 0.0 };
+
+    juce::SharedResourcePointer<SharedCoefficientCache> sharedCache;
+    std::array<PathReferences, numChainPaths> references;
+};
@@ -0,0 +1,86 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.cpp
+    Designs filter coefficients away from the audio thread.
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+
+CoefficientDesigner::CoefficientDesigner(juce::AudioProcessorValueTreeState& state)
+    : apvts(state)
+{
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+    release();
+}
+
+void CoefficientDesigner::prepare(double newSampleRate)
+{
+    release();
+
+    {
+        const juce::ScopedLock sl(designLock);
+        cache.setSampleRate(newSampleRate);
+    }
+
+    dirtyStages.fetch_or(allPathsDirty);
+    designPendingStages();
+
+    worker->addClient(*this);
+}
+
+void CoefficientDesigner::release()
+{
+    worker->removeClient(*this);
+}
+
+void CoefficientDesigner::markDirty(int stages, int path) noexcept
+{
+    auto bits = static_cast<juce::uint64>(stages) << (path * stageBitsPerPath);
+
+    // Stages already dirty have a design on its way.
+    if ((dirtyStages.fetch_or(bits) & bits) != bits)
+        worker->requestDesign(*this);
+}
+
+void CoefficientDesigner::markAllDirty() noexcept
+{
+    if (dirtyStages.fetch_or(allPathsDirty) != allPathsDirty)
+        worker->requestDesign(*this);
+}
+
+void CoefficientDesigner::designPendingStages()
+{
+    const juce::ScopedLock sl(designLock);
+
+    auto dirty = dirtyStages.exchange(0);
+
+    if (dirty == 0)
+        return;
+
+    for (int path = 0; path < numChainPaths; ++path)
+    {
+        auto stages = static_cast<int>(dirty >> (path * stageBitsPerPath)) & AllStagesDirty;
+
+        if (stages != 0)
+            cache.design(designed[path], getChainSettings(apvts, path), stages, path);
+    }
+
+    exchange.getWriteBuffer() = designed;
+    exchange.publish();
+}
+
+const PathCoefficients* CoefficientDesigner::acquireLatest() noexcept
+{
+    return exchange.acquire();
+}
+
+void CoefficientDesigner::designPending()
+{
+    designPendingStages();
+}
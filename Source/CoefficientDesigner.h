@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    CoefficientDesigner.h
+    Designs filter coefficients away from the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "CoefficientCache.h"
+#include "TripleBuffer.h"
+#include "DesignWorker.h"
+
+/**
+    Owns the coefficient design for one processor.
+
+    Parameter changes mark chain stages dirty; the shared DesignWorker thread
+    redesigns only those stages (the JUCE design functions allocate), going through a
+    CoefficientCache so revisited settings are not designed twice, and publishes a
+    complete PathCoefficients snapshot (both paths) through a TripleBuffer. The audio thread
+    picks the newest snapshot up with acquireLatest(), which never blocks,
+    allocates or frees anything.
+*/
+class CoefficientDesigner : private DesignWorker::Client
+{
+public:
+    explicit CoefficientDesigner(juce::AudioProcessorValueTreeState& apvts);
+    ~CoefficientDesigner() override;
+
+    // Designs every stage synchronously, then registers with the worker.
+    // Call while the audio thread is not processing.
+    void prepare(double sampleRate);
+    void release();
+
+    // May be called from any thread including the audio thread. Only wakes
+    // the worker when a stage turns dirty that wasn't already.
+    void markDirty(int stages, int path = PathA) noexcept;
+    void markAllDirty() noexcept;
+
+    // Designs whatever is dirty on the calling thread. Used by the worker,
+    // and by the audio thread when rendering offline so that parameter
+    // changes land on deterministic blocks.
+    void designPendingStages();
+
+    // Audio thread only. Returns the newest snapshot, or nullptr if nothing was
+    // published since the last call. The pointer stays valid until the next call.
+    const PathCoefficients* acquireLatest() noexcept;
+
+private:
+    void designPending() override;
+
+    // Both paths' DirtyStages share one atomic, path B's in the upper half.
+    static constexpr int stageBitsPerPath = 32;
+    static constexpr juce::uint64 allPathsDirty = static_cast<juce::uint64>(AllStagesDirty)
+                                                | (static_cast<juce::uint64>(AllStagesDirty) << stageBitsPerPath);
+
+    juce::AudioProcessorValueTreeState& apvts;
+    juce::SharedResourcePointer<DesignWorker> worker;
+
+    std::atomic<juce::uint64> dirtyStages{ allPathsDirty };
+
+    juce::CriticalSection designLock;
+    CoefficientCache cache;
+    PathCoefficients designed;
+
+    TripleBuffer<PathCoefficients> exchange;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
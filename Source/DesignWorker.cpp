@@ -0,0 +1,84 @@
+/*
+  ==============================================================================
+
+    DesignWorker.cpp
+    One background thread that runs the designs of every plugin instance.
+
+  ==============================================================================
+*/
+
+#include "DesignWorker.h"
+
+DesignWorker::DesignWorker()
+    : juce::Thread("EEAV design worker")
+{
+    startThread();
+}
+
+DesignWorker::~DesignWorker()
+{
+    jassert(clients.isEmpty());
+    stopThread(1000);
+}
+
+void DesignWorker::addClient(Client& client)
+{
+    {
+        const juce::ScopedLock sl(clientLock);
+        clients.addIfNotAlreadyThere(&client);
+    }
+
+    // Anything requested while it was unregistered is served now.
+    if (client.designRequested.load())
+        notify();
+}
+
+void DesignWorker::removeClient(Client& client)
+{
+    {
+        const juce::ScopedLock sl(clientLock);
+        clients.removeAllInstancesOf(&client);
+    }
+
+    // Held by the thread while it designs for this client, and only then.
+    const juce::ScopedLock sl(client.designLock);
+}
+
+void DesignWorker::requestDesign(Client& client) noexcept
+{
+    client.designRequested.store(true);
+    notify();
+}
+
+void DesignWorker::run()
+{
+    while (!threadShouldExit())
+    {
+        // A request made during the pass below signals the event again, so
+        // it is picked up by the next pass rather than lost.
+        wait(-1);
+
+        {
+            const juce::ScopedLock sl(clientLock);
+            pass = clients;
+        }
+
+        // Designs run outside clientLock, so adding and removing other
+        // clients never waits for them.
+        for (auto* client : pass)
+        {
+            {
+                // Removed clients may already be gone.
+                const juce::ScopedLock sl(clientLock);
+
+                if (!clients.contains(client) || !client->designRequested.exchange(false))
+                    continue;
+
+                client->designLock.enter();
+            }
+
+            client->designPending();
+            client->designLock.exit();
+        }
+    }
+}
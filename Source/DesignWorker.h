@@ -0,0 +1,68 @@
+/*
+  ==============================================================================
+
+    DesignWorker.h
+    One background thread that runs the designs of every plugin instance.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Runs the coefficient and kernel designs of every instance in the process
+    on a single thread, held through a SharedResourcePointer, so a session
+    with hundreds of instances still has one design thread.
+
+    The thread sleeps until a client asks for a design with requestDesign(),
+    then calls designPending() on each registered client that asked, and
+    goes back to sleep. Nothing wakes it while no parameter moves.
+
+    Clients are only served while registered. The designs run outside the
+    lock on the client list, so removeClient() only waits for a design of
+    that same client in progress; it may free anything the design uses
+    afterwards.
+*/
+class DesignWorker : private juce::Thread
+{
+public:
+    class Client
+    {
+    public:
+        virtual ~Client() = default;
+
+    private:
+        friend class DesignWorker;
+
+        // Called on the worker thread after requestDesign().
+        virtual void designPending() = 0;
+
+        std::atomic<bool> designRequested{ false };
+
+        // Held while the worker designs for this client.
+        juce::CriticalSection designLock;
+    };
+
+    DesignWorker();
+    ~DesignWorker() override;
+
+    void addClient(Client& client);
+    void removeClient(Client& client);
+
+    // May be called from any thread including the audio thread. Never
+    // blocks on a design; waking the thread only takes its event's lock.
+    void requestDesign(Client& client) noexcept;
+
+private:
+    void run() override;
+
+    juce::CriticalSection clientLock;
+    juce::Array<Client*> clients;
+
+    // The clients as the current pass found them. Worker thread only.
+    juce::Array<Client*> pass;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DesignWorker)
+};
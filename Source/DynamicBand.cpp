@@ -0,0 +1,144 @@
+/*
+  ==============================================================================
+
+    DynamicBand.cpp
+    Envelope follower that turns band 0 into a dynamic EQ band.
+
+  ==============================================================================
+*/
+
+#include "DynamicBand.h"
+
+void DynamicBand::prepare(double newSampleRate, int maximumBlockSize)
+{
+    sampleRate = newSampleRate;
+
+    monoKey.assign(static_cast<size_t>(juce::jmax(1, maximumBlockSize)), 0.f);
+    gains.assign(monoKey.size(), 0.f);
+
+    reset();
+}
+
+void DynamicBand::reset() noexcept
+{
+    state1 = state2 = 0.0;
+    gainInDecibels = 0.f;
+    numGains = 0;
+}
+
+int DynamicBand::mixDown(const float* const* key, int numChannels, int numSamples) noexcept
+{
+    numSamples = juce::jmin(numSamples, static_cast<int>(monoKey.size()));
+
+    if (numChannels <= 0)
+    {
+        juce::FloatVectorOperations::clear(monoKey.data(), numSamples);
+        return numSamples;
+    }
+
+    auto scale = 1.f / static_cast<float>(numChannels);
+
+    juce::FloatVectorOperations::copyWithMultiply(monoKey.data(), key[0], scale, numSamples);
+
+    for (int channel = 1; channel < numChannels; ++channel)
+        juce::FloatVectorOperations::addWithMultiply(monoKey.data(), key[channel], scale, numSamples);
+
+    return numSamples;
+}
+
+int DynamicBand::mixDown(const double* const* key, int numChannels, int numSamples) noexcept
+{
+    numSamples = juce::jmin(numSamples, static_cast<int>(monoKey.size()));
+
+    // The level only needs float precision, and the rest of the detector
+    // runs on the float vector operations.
+    auto scale = numChannels > 0 ? 1.0 / numChannels : 0.0;
+    auto* mono = monoKey.data();
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        double sum = 0.0;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            sum += key[channel][i];
+
+        mono[i] = static_cast<float>(sum * scale);
+    }
+
+    return numSamples;
+}
+
+void DynamicBand::process(const float* const* key, int numChannels, int numSamples,
+                          float frequency, float quality,
+                          const DynamicSettings& settings, int interval) noexcept
+{
+    analyse(mixDown(key, numChannels, numSamples), frequency, quality, settings, interval);
+}
+
+void DynamicBand::process(const double* const* key, int numChannels, int numSamples,
+                          float frequency, float quality,
+                          const DynamicSettings& settings, int interval) noexcept
+{
+    analyse(mixDown(key, numChannels, numSamples), frequency, quality, settings, interval);
+}
+
+void DynamicBand::analyse(int numSamples, float frequency, float quality, const DynamicSettings& settings, int interval) noexcept
+{
+    auto* mono = monoKey.data();
+
+    // One biquad on one channel; cheap enough to set up every block, so the
+    // band's frequency and Q are always followed.
+    auto bandPass = calculateBandPass(sampleRate, frequency, quality);
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto input = static_cast<double>(mono[i]);
+        auto output = bandPass.b0 * input + state1;
+
+        state1 = bandPass.b1 * input - bandPass.a1 * output + state2;
+        state2 = bandPass.b2 * input - bandPass.a2 * output;
+
+        mono[i] = static_cast<float>(output);
+    }
+
+    interval = juce::jmax(1, interval);
+
+    auto slope = 1.f - 1.f / juce::jmax(1.f, settings.ratio);
+    auto getCoefficient = [this](int length, float milliseconds)
+    {
+        return static_cast<float>(std::exp(-length / (sampleRate * 0.001 * juce::jmax(0.01f, milliseconds))));
+    };
+
+    // Every interval but the block's last has the full length.
+    auto attack = getCoefficient(interval, settings.attackMilliseconds);
+    auto release = getCoefficient(interval, settings.releaseMilliseconds);
+
+    numGains = 0;
+
+    for (int start = 0; start < numSamples; start += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - start);
+        auto range = juce::FloatVectorOperations::findMinAndMax(mono + start, length);
+        auto level = juce::Decibels::gainToDecibels(juce::jmax(-range.getStart(), range.getEnd()), -120.f);
+
+        auto over = level - settings.thresholdInDecibels;
+        auto target = over > 0.f ? -over * slope : 0.f;
+
+        auto coefficient = target < gainInDecibels ? attack : release;
+
+        if (length != interval)
+            coefficient = getCoefficient(length, target < gainInDecibels ? settings.attackMilliseconds
+                                                                         : settings.releaseMilliseconds);
+
+        gainInDecibels = target + (gainInDecibels - target) * coefficient;
+        gains[static_cast<size_t>(numGains++)] = gainInDecibels;
+    }
+}
+
+float DynamicBand::getGainInDecibels(int intervalIndex) const noexcept
+{
+    if (numGains == 0)
+        return gainInDecibels;
+
+    return gains[static_cast<size_t>(juce::jlimit(0, numGains - 1, intervalIndex))];
+}
@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    DynamicBand.h
+    Envelope follower that turns band 0 into a dynamic EQ band.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+// The "Dynamic ..." parameters, read once per block.
+struct DynamicSettings
+{
+    float thresholdInDecibels{ -20.f };
+    float ratio{ 4.f };
+    float attackMilliseconds{ 5.f };
+    float releaseMilliseconds{ 100.f };
+};
+
+/**
+    Follows the level of a key signal in one band and works out how far the
+    band's gain should move, like a compressor's gain computer.
+
+    The key's channels are summed to mono and band-passed at the band's
+    frequency and Q, so only what the band would act on drives it. Its peak
+    level is then taken once per update interval with the vectorised
+    FloatVectorOperations, and the attack and release ballistics run at that
+    rate rather than per sample. Above the threshold the band's gain drops
+    by (1 - 1 / ratio) dB per dB.
+
+    One gain is produced per interval of the block, so the filters downstream
+    are updated at most that often. Host rate, audio thread only.
+*/
+class DynamicBand
+{
+public:
+    void prepare(double sampleRate, int maximumBlockSize);
+    void reset() noexcept;
+
+    // Runs the detector over one block of the key. Blocks longer than the
+    // prepared maximum are only analysed up to it.
+    void process(const float* const* key, int numChannels, int numSamples,
+                 float frequency, float quality,
+                 const DynamicSettings& settings, int interval) noexcept;
+    void process(const double* const* key, int numChannels, int numSamples,
+                 float frequency, float quality,
+                 const DynamicSettings& settings, int interval) noexcept;
+
+    // Gain change for the interval starting `intervalIndex` intervals into
+    // the last block processed, 0 dB or less.
+    float getGainInDecibels(int intervalIndex) const noexcept;
+
+private:
+    double sampleRate{ 44100.0 };
+
+    std::vector<float> monoKey;
+    std::vector<float> gains;
+    int numGains{ 0 };
+
+    // The band-pass, in transposed direct form II.
+    double state1{ 0.0 }, state2{ 0.0 };
+    float gainInDecibels{ 0.f };
+
+    int mixDown(const float* const* key, int numChannels, int numSamples) noexcept;
+    int mixDown(const double* const* key, int numChannels, int numSamples) noexcept;
+
+    void analyse(int numSamples, float frequency, float quality, const DynamicSettings& settings, int interval) noexcept;
+};
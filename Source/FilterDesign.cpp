@@ -0,0 +1,741 @@
+/*
+  ==============================================================================
+
+    FilterDesign.cpp
+    Parameter snapshot, filter chain types and coefficient design helpers
+    shared by the processor, the coefficient designer and the editor.
+
+  ==============================================================================
+*/
+
+#include "FilterDesign.h"
+
+juce::String getParameterID(const juce::String& pathAParameterID, int path)
+{
+    return path == PathB ? pathAParameterID + " B" : pathAParameterID;
+}
+
+int getChainPathForParameter(const juce::String& parameterID)
+{
+    return parameterID.endsWith(" B") ? PathB : PathA;
+}
+
+juce::String getBandParameterID(const juce::String& band0ParameterID, int band)
+{
+    return band == 0 ? band0ParameterID : band0ParameterID + " " + juce::String(band + 1);
+}
+
+int getBandForParameter(const juce::String& parameterID)
+{
+    auto pathAParameterID = getChainPathForParameter(parameterID) == PathB ? parameterID.dropLastCharacters(2) : parameterID;
+    auto lastWord = pathAParameterID.fromLastOccurrenceOf(" ", false, false);
+
+    return lastWord.containsOnly("0123456789") ? juce::jlimit(0, maxBands - 1, lastWord.getIntValue() - 1) : 0;
+}
+
+ChainParameters::ChainParameters(juce::AudioProcessorValueTreeState& apvts, int path)
+{
+    auto find = [&apvts, path](const juce::String& pathAParameterID)
+    {
+        auto* parameter = apvts.getRawParameterValue(getParameterID(pathAParameterID, path));
+        jassert(parameter != nullptr);
+        return parameter;
+    };
+
+    lowCutFreq = find("LowCut Freq");
+    highCutFreq = find("HighCut Freq");
+    lowCutSlope = find("LowCut Slope");
+    highCutSlope = find("HighCut Slope");
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        peakFreq[band] = find(getBandParameterID("Peak Freq", band));
+        peakGain[band] = find(getBandParameterID("Peak Gain", band));
+        peakQuality[band] = find(getBandParameterID("Peak Quality", band));
+        filterName[band] = find(getBandParameterID("Choose filter", band));
+        bandEnabled[band] = find(getBandParameterID("Peak On", band));
+    }
+
+    designMethod = apvts.getRawParameterValue("Design");
+    jassert(designMethod != nullptr);
+}
+
+ChainSettings ChainParameters::load() const noexcept
+{
+	ChainSettings settings;
+
+    settings.lowCutFreq = lowCutFreq->load();
+    settings.highCutFreq = highCutFreq->load();
+    settings.lowCutSlope = static_cast<Slope>(lowCutSlope->load());
+    settings.highCutSlope = static_cast<Slope>(highCutSlope->load());
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        settings.bandEnabled[band] = bandEnabled[band]->load() > 0.5f;
+        settings.filterName[band] = static_cast<FilterType>(filterName[band]->load());
+        settings.peakFreq[band] = peakFreq[band]->load();
+        settings.peakGainInDecibels[band] = peakGain[band]->load();
+        settings.peakQuality[band] = peakQuality[band]->load();
+    }
+
+    settings.designMethod = static_cast<DesignMethod>(designMethod->load());
+
+	return settings;
+}
+
+int ChainParameters::apply(ChainSettings& settings, const std::atomic<float>* parameter, float value) const noexcept
+{
+    if (parameter == lowCutFreq || parameter == lowCutSlope)
+    {
+        if (parameter == lowCutFreq)
+            settings.lowCutFreq = value;
+        else
+            settings.lowCutSlope = static_cast<Slope>(value);
+
+        return LowCutDirty;
+    }
+
+    if (parameter == highCutFreq || parameter == highCutSlope)
+    {
+        if (parameter == highCutFreq)
+            settings.highCutFreq = value;
+        else
+            settings.highCutSlope = static_cast<Slope>(value);
+
+        return HighCutDirty;
+    }
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (parameter == peakFreq[band])
+            settings.peakFreq[band] = value;
+        else if (parameter == peakGain[band])
+            settings.peakGainInDecibels[band] = value;
+        else if (parameter == peakQuality[band])
+            settings.peakQuality[band] = value;
+        else if (parameter == filterName[band])
+            settings.filterName[band] = static_cast<FilterType>(value);
+        else if (parameter == bandEnabled[band])
+            settings.bandEnabled[band] = value > 0.5f;
+        else
+            continue;
+
+        return getBandDirtyBit(band);
+    }
+
+    return 0;
+}
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int path) 
+{
+    return ChainParameters(apvts, path).load();
+}
+
+void setChainSettings(juce::AudioProcessorValueTreeState& apvts, const ChainSettings& chainSettings, int path)
+{
+    auto set = [&apvts, path](const juce::String& pathAParameterID, float value)
+    {
+        auto* parameter = apvts.getParameter(getParameterID(pathAParameterID, path));
+        jassert(parameter != nullptr);
+
+        parameter->setValueNotifyingHost(parameter->convertTo0to1(value));
+    };
+
+    set("LowCut Freq", chainSettings.lowCutFreq);
+    set("HighCut Freq", chainSettings.highCutFreq);
+    set("LowCut Slope", static_cast<float>(chainSettings.lowCutSlope));
+    set("HighCut Slope", static_cast<float>(chainSettings.highCutSlope));
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        set(getBandParameterID("Peak Freq", band), chainSettings.peakFreq[band]);
+        set(getBandParameterID("Peak Gain", band), chainSettings.peakGainInDecibels[band]);
+        set(getBandParameterID("Peak Quality", band), chainSettings.peakQuality[band]);
+        set(getBandParameterID("Choose filter", band), static_cast<float>(chainSettings.filterName[band]));
+        set(getBandParameterID("Peak On", band), chainSettings.bandEnabled[band] ? 1.f : 0.f);
+    }
+}
+
+StereoMode getStereoMode(juce::AudioProcessorValueTreeState& apvts)
+{
+    return static_cast<StereoMode>(static_cast<int>(apvts.getRawParameterValue("Stereo Mode")->load()));
+}
+
+FilterEngine getFilterEngine(juce::AudioProcessorValueTreeState& apvts)
+{
+    return static_cast<FilterEngine>(static_cast<int>(apvts.getRawParameterValue("Engine")->load()));
+}
+
+ChainSettings getEngineChainSettings(ChainSettings chainSettings, FilterEngine engine)
+{
+    if (engine == TPTEngine)
+        chainSettings.designMethod = BilinearDesign;
+
+    return chainSettings;
+}
+
+template <typename SampleType>
+Coefficients<SampleType> makePeakFilter(const ChainSettings& chainSettings, int band, double sampleRate)
+{
+	return juce::dsp::IIR::Coefficients<SampleType>::makePeakFilter(sampleRate,
+		chainSettings.peakFreq[band],
+		chainSettings.peakQuality[band],
+		juce::Decibels::decibelsToGain(static_cast<SampleType>(chainSettings.peakGainInDecibels[band])));
+}
+
+template <typename SampleType>
+Coefficients<SampleType> makeNotchFilter(const ChainSettings& chainSettings, int band, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<SampleType>::makeNotch(sampleRate,
+        chainSettings.peakFreq[band],
+        chainSettings.peakQuality[band]);
+}
+
+template <typename SampleType>
+Coefficients<SampleType> makeBandPassFilter(const ChainSettings& chainSettings, int band, double sampleRate)
+{
+    return juce::dsp::IIR::Coefficients<SampleType>::makeBandPass(sampleRate,
+        chainSettings.peakFreq[band],
+        chainSettings.peakQuality[band]);
+}
+
+template <typename SampleType>
+Coefficients<SampleType> makeBandFilter(const ChainSettings& chainSettings, int band, double sampleRate)
+{
+    switch (chainSettings.filterName[band])
+    {
+    case PeakFilter:
+        return makePeakFilter<SampleType>(chainSettings, band, sampleRate);
+    case NotchFilter:
+        return makeNotchFilter<SampleType>(chainSettings, band, sampleRate);
+    case BandPassFilter:
+        return makeBandPassFilter<SampleType>(chainSettings, band, sampleRate);
+    default:
+        jassertfalse; // Invalid filter type
+        return {};
+    }
+}
+
+template Coefficients<float> makePeakFilter<float>(const ChainSettings&, int, double);
+template Coefficients<double> makePeakFilter<double>(const ChainSettings&, int, double);
+template Coefficients<float> makeNotchFilter<float>(const ChainSettings&, int, double);
+template Coefficients<double> makeNotchFilter<double>(const ChainSettings&, int, double);
+template Coefficients<float> makeBandPassFilter<float>(const ChainSettings&, int, double);
+template Coefficients<double> makeBandPassFilter<double>(const ChainSettings&, int, double);
+template Coefficients<float> makeBandFilter<float>(const ChainSettings&, int, double);
+template Coefficients<double> makeBandFilter<double>(const ChainSettings&, int, double);
+
+int getDirtyStagesForParameter(const juce::String& parameterID)
+{
+    if (parameterID.startsWith("LowCut"))
+        return LowCutDirty;
+    if (parameterID.startsWith("HighCut"))
+        return HighCutDirty;
+    if (parameterID.startsWith("Choose filter") || parameterID.startsWith("Peak"))
+        return getBandDirtyBit(getBandForParameter(parameterID));
+    if (parameterID == "Smoothing" || parameterID == "Engine" || parameterID == "Oversampling"
+        || parameterID == "Stereo Mode" || parameterID == "Design")
+        return AllStagesDirty;
+
+    jassertfalse; // Unknown parameter, be conservative
+    return AllStagesDirty;
+}
+
+template <typename SampleType>
+BiquadCoefficients toBiquadCoefficients(const juce::dsp::IIR::Coefficients<SampleType>& coefficients)
+{
+    // IIR::Coefficients stores a biquad normalised by a0 as { b0, b1, b2, a1, a2 }
+    jassert(coefficients.getFilterOrder() == 2);
+
+    const auto* c = coefficients.coefficients.begin();
+    return { c[0], c[1], c[2], c[3], c[4] };
+}
+
+template BiquadCoefficients toBiquadCoefficients<float>(const juce::dsp::IIR::Coefficients<float>&);
+template BiquadCoefficients toBiquadCoefficients<double>(const juce::dsp::IIR::Coefficients<double>&);
+
+template<typename CoefficientArray>
+static CutCoefficients toCutCoefficients(const CoefficientArray& cutCoefficients)
+{
+    CutCoefficients cut;
+    cut.numSections = juce::jmin(cutCoefficients.size(), static_cast<int>(cut.sections.size()));
+
+    for (int i = 0; i < cut.numSections; ++i)
+        cut.sections[i] = toBiquadCoefficients(*cutCoefficients[i]);
+
+    return cut;
+}
+
+// Designed in double so that neither engine loses precision here.
+CutCoefficients designLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    if (chainSettings.designMethod == MatchedDesign)
+        return calculateLowCutCoefficients(chainSettings, sampleRate);
+
+    return toCutCoefficients(makeLowCutFilter<double>(chainSettings, sampleRate));
+}
+
+CutCoefficients designHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate)
+{
+    if (chainSettings.designMethod == MatchedDesign)
+        return calculateHighCutCoefficients(chainSettings, sampleRate);
+
+    return toCutCoefficients(makeHighCutFilter<double>(chainSettings, sampleRate));
+}
+
+BiquadCoefficients designBandCoefficients(const ChainSettings& chainSettings, int band, double sampleRate)
+{
+    if (!chainSettings.bandEnabled[band])
+        return {};
+
+    if (chainSettings.designMethod == MatchedDesign)
+        return calculateBandCoefficients(chainSettings, band, sampleRate);
+
+    if (auto bandCoefficients = makeBandFilter<double>(chainSettings, band, sampleRate))
+        return toBiquadCoefficients(*bandCoefficients);
+
+    return {};
+}
+
+void designChainCoefficients(ChainCoefficients& destination,
+    const ChainSettings& chainSettings,
+    double sampleRate,
+    int stages)
+{
+    if (stages & LowCutDirty)
+        destination.lowCut = designLowCutCoefficients(chainSettings, sampleRate);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (stages & getBandDirtyBit(band))
+        {
+            destination.bands[band] = designBandCoefficients(chainSettings, band, sampleRate);
+            destination.bandEnabled[band] = chainSettings.bandEnabled[band];
+        }
+    }
+
+    if (stages & HighCutDirty)
+        destination.highCut = designHighCutCoefficients(chainSettings, sampleRate);
+}
+
+//==============================================================================
+static BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2) noexcept
+{
+    auto a0Inv = 1.0 / a0;
+
+    return { b0 * a0Inv, b1 * a0Inv, b2 * a0Inv, a1 * a0Inv, a2 * a0Inv };
+}
+
+// 1 / tan(pi * f / fs), the bilinear transform prewarp shared by every section
+// designed at the same frequency.
+static double prewarp(double sampleRate, float frequency) noexcept
+{
+    return 1.0 / std::tan(juce::MathConstants<double>::pi * frequency / sampleRate);
+}
+
+static BiquadCoefficients lowPassFromPrewarp(double n, double quality) noexcept
+{
+    auto nSquared = n * n;
+    auto invQ = 1.0 / quality;
+
+    return normalise(1.0, 2.0, 1.0, 1.0 + invQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - invQ * n + nSquared);
+}
+
+static BiquadCoefficients highPassFromPrewarp(double n, double quality) noexcept
+{
+    auto nSquared = n * n;
+    auto invQ = 1.0 / quality;
+
+    return normalise(nSquared, -2.0 * nSquared, nSquared, 1.0 + invQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - invQ * n + nSquared);
+}
+
+BiquadCoefficients calculateLowPass(double sampleRate, float frequency, float quality) noexcept
+{
+    return lowPassFromPrewarp(prewarp(sampleRate, frequency), quality);
+}
+
+BiquadCoefficients calculateHighPass(double sampleRate, float frequency, float quality) noexcept
+{
+    return highPassFromPrewarp(prewarp(sampleRate, frequency), quality);
+}
+
+BiquadCoefficients calculatePeakFilter(double sampleRate, float frequency, float quality, float gainFactor) noexcept
+{
+    auto A = std::sqrt(juce::jmax(0.0, static_cast<double>(gainFactor)));
+    auto omega = juce::MathConstants<double>::twoPi * juce::jmax(static_cast<double>(frequency), 2.0) / sampleRate;
+    auto alpha = std::sin(omega) / (2.0 * quality);
+    auto c2 = -2.0 * std::cos(omega);
+
+    return normalise(1.0 + alpha * A, c2, 1.0 - alpha * A, 1.0 + alpha / A, c2, 1.0 - alpha / A);
+}
+
+BiquadCoefficients calculateNotch(double sampleRate, float frequency, float quality) noexcept
+{
+    auto n = prewarp(sampleRate, frequency);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / quality;
+
+    return normalise(1.0 + nSquared, 2.0 * (1.0 - nSquared), 1.0 + nSquared,
+                     1.0 + n * invQ + nSquared, 2.0 * (1.0 - nSquared), 1.0 - n * invQ + nSquared);
+}
+
+BiquadCoefficients calculateBandPass(double sampleRate, float frequency, float quality) noexcept
+{
+    auto n = prewarp(sampleRate, frequency);
+    auto nSquared = n * n;
+    auto invQ = 1.0 / quality;
+
+    return normalise(n * invQ, 0.0, -n * invQ,
+                     1.0 + invQ * n + nSquared, 2.0 * (1.0 - nSquared), 1.0 - invQ * n + nSquared);
+}
+
+//==============================================================================
+// The analog poles mapped by z = exp(sT), and the terms the magnitude
+// fits are built from. |H|^2 of a biquad is a ratio of linear forms in
+// phi0 = cos^2(w / 2), phi1 = sin^2(w / 2) and phi2 = 4 phi0 phi1, with
+// coefficients A0..A2 for the denominator and B0..B2 for the numerator.
+struct MatchedPoles
+{
+    double a1, a2;
+    double A0, A1, A2;
+    double phi0, phi1, phi2;
+
+    // A0 phi0 + A1 phi1 + A2 phi2, the denominator at the centre frequency.
+    double getDenominatorAtCentre() const noexcept { return A0 * phi0 + A1 * phi1 + A2 * phi2; }
+    double getDenominatorSlope() const noexcept { return -A0 + A1 + 4.0 * (phi0 - phi1) * A2; }
+};
+
+static MatchedPoles matchPoles(double sampleRate, float frequency, double quality) noexcept
+{
+    // Just short of Nyquist, where the fits below degenerate.
+    auto w0 = juce::MathConstants<double>::twoPi * juce::jlimit(2.0, 0.499 * sampleRate, static_cast<double>(frequency)) / sampleRate;
+    auto q = 0.5 / quality;
+    auto decay = std::exp(-q * w0);
+
+    MatchedPoles poles;
+    poles.a1 = q <= 1.0 ? -2.0 * decay * std::cos(std::sqrt(1.0 - q * q) * w0)
+                        : -2.0 * decay * std::cosh(std::sqrt(q * q - 1.0) * w0);
+    poles.a2 = decay * decay;
+
+    poles.A0 = (1.0 + poles.a1 + poles.a2) * (1.0 + poles.a1 + poles.a2);
+    poles.A1 = (1.0 - poles.a1 + poles.a2) * (1.0 - poles.a1 + poles.a2);
+    poles.A2 = -4.0 * poles.a2;
+
+    auto sine = std::sin(0.5 * w0);
+    poles.phi1 = sine * sine;
+    poles.phi0 = 1.0 - poles.phi1;
+    poles.phi2 = 4.0 * poles.phi0 * poles.phi1;
+
+    return poles;
+}
+
+static double safeSqrt(double value) noexcept
+{
+    return std::sqrt(juce::jmax(0.0, value));
+}
+
+BiquadCoefficients calculateMatchedLowPass(double sampleRate, float frequency, float quality) noexcept
+{
+    auto poles = matchPoles(sampleRate, frequency, quality);
+
+    auto R1 = poles.getDenominatorAtCentre() * quality * quality;
+    auto B0 = poles.A0;
+    auto B1 = (R1 - B0 * poles.phi0) / poles.phi1;
+
+    auto b0 = 0.5 * (std::sqrt(B0) + safeSqrt(B1));
+    auto b1 = std::sqrt(B0) - b0;
+
+    return { b0, b1, 0.0, poles.a1, poles.a2 };
+}
+
+BiquadCoefficients calculateMatchedHighPass(double sampleRate, float frequency, float quality) noexcept
+{
+    auto poles = matchPoles(sampleRate, frequency, quality);
+    auto b0 = safeSqrt(poles.getDenominatorAtCentre()) * quality / (4.0 * poles.phi1);
+
+    return { b0, -2.0 * b0, b0, poles.a1, poles.a2 };
+}
+
+BiquadCoefficients calculateMatchedPeakFilter(double sampleRate, float frequency, float quality, float gainFactor) noexcept
+{
+    // The RBJ prototype, (s^2 + s A / Q + 1) / (s^2 + s / (A Q) + 1) with
+    // A^2 the gain, has its poles at a Q of A Q.
+    auto gain = juce::jmax(1.0e-6, static_cast<double>(gainFactor));
+    auto poles = matchPoles(sampleRate, frequency, quality * std::sqrt(gain));
+    auto gainSquared = gain * gain;
+
+    auto R1 = poles.getDenominatorAtCentre() * gainSquared;
+    auto R2 = poles.getDenominatorSlope() * gainSquared;
+
+    auto B0 = poles.A0;
+    auto B2 = (R1 - R2 * poles.phi1 - B0) / (4.0 * poles.phi1 * poles.phi1);
+    auto B1 = R2 + B0 + 4.0 * (poles.phi1 - poles.phi0) * B2;
+
+    auto W = 0.5 * (std::sqrt(B0) + safeSqrt(B1));
+    auto b0 = 0.5 * (W + safeSqrt(W * W + B2));
+    auto b1 = 0.5 * (std::sqrt(B0) - safeSqrt(B1));
+    auto b2 = -B2 / (4.0 * b0);
+
+    return { b0, b1, b2, poles.a1, poles.a2 };
+}
+
+BiquadCoefficients calculateMatchedNotch(double sampleRate, float frequency, float quality) noexcept
+{
+    auto poles = matchPoles(sampleRate, frequency, quality);
+
+    // Zeros exactly at the centre frequency, scaled for unity gain at DC.
+    auto c = -2.0 * std::cos(juce::MathConstants<double>::twoPi * juce::jlimit(2.0, 0.499 * sampleRate, static_cast<double>(frequency)) / sampleRate);
+    auto b0 = (1.0 + poles.a1 + poles.a2) / (2.0 + c);
+
+    return { b0, b0 * c, b0, poles.a1, poles.a2 };
+}
+
+BiquadCoefficients calculateMatchedBandPass(double sampleRate, float frequency, float quality) noexcept
+{
+    auto poles = matchPoles(sampleRate, frequency, quality);
+
+    auto R1 = poles.getDenominatorAtCentre();
+    auto R2 = poles.getDenominatorSlope();
+
+    auto B2 = (R1 - R2 * poles.phi1) / (4.0 * poles.phi1 * poles.phi1);
+    auto B1 = R2 + 4.0 * (poles.phi1 - poles.phi0) * B2;
+
+    auto b1 = -0.5 * safeSqrt(B1);
+    auto b0 = 0.5 * (safeSqrt(B2 + b1 * b1) - b1);
+
+    return { b0, b1, -b0 - b1, poles.a1, poles.a2 };
+}
+
+// Section Qs of an even order Butterworth filter, as used by
+// FilterDesign::design*HighOrderButterworthMethod.
+static double butterworthSectionQuality(int section, int order) noexcept
+{
+    return 1.0 / (2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+}
+
+template<typename SectionFunction>
+static CutCoefficients calculateCutCoefficients(float frequency, int slope, double sampleRate, SectionFunction&& section) noexcept
+{
+    CutCoefficients cut;
+    cut.numSections = juce::jlimit(1, static_cast<int>(cut.sections.size()), slope + 1);
+
+    auto n = prewarp(sampleRate, frequency);
+    auto order = 2 * cut.numSections;
+
+    for (int i = 0; i < cut.numSections; ++i)
+        cut.sections[i] = section(n, butterworthSectionQuality(i, order));
+
+    return cut;
+}
+
+// The same cascade with every section matched on its own, which matches the
+// whole cascade's magnitude as closely.
+template<typename SectionFunction>
+static CutCoefficients calculateMatchedCutCoefficients(float frequency, int slope, double sampleRate, SectionFunction&& section) noexcept
+{
+    CutCoefficients cut;
+    cut.numSections = juce::jlimit(1, static_cast<int>(cut.sections.size()), slope + 1);
+
+    auto order = 2 * cut.numSections;
+
+    for (int i = 0; i < cut.numSections; ++i)
+        cut.sections[i] = section(sampleRate, frequency, static_cast<float>(butterworthSectionQuality(i, order)));
+
+    return cut;
+}
+
+CutCoefficients calculateLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    if (chainSettings.designMethod == MatchedDesign)
+        return calculateMatchedCutCoefficients(chainSettings.lowCutFreq, chainSettings.lowCutSlope, sampleRate, calculateMatchedHighPass);
+
+    return calculateCutCoefficients(chainSettings.lowCutFreq, chainSettings.lowCutSlope, sampleRate, highPassFromPrewarp);
+}
+
+CutCoefficients calculateHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept
+{
+    if (chainSettings.designMethod == MatchedDesign)
+        return calculateMatchedCutCoefficients(chainSettings.highCutFreq, chainSettings.highCutSlope, sampleRate, calculateMatchedLowPass);
+
+    return calculateCutCoefficients(chainSettings.highCutFreq, chainSettings.highCutSlope, sampleRate, lowPassFromPrewarp);
+}
+
+BiquadCoefficients calculateBandCoefficients(const ChainSettings& chainSettings, int band, double sampleRate) noexcept
+{
+    if (!chainSettings.bandEnabled[band])
+        return {};
+
+    auto frequency = chainSettings.peakFreq[band];
+    auto quality = chainSettings.peakQuality[band];
+
+    if (chainSettings.designMethod == MatchedDesign)
+    {
+        switch (chainSettings.filterName[band])
+        {
+        case PeakFilter:
+            return calculateMatchedPeakFilter(sampleRate,
+                frequency,
+                quality,
+                juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels[band]));
+        case NotchFilter:
+            return calculateMatchedNotch(sampleRate, frequency, quality);
+        case BandPassFilter:
+            return calculateMatchedBandPass(sampleRate, frequency, quality);
+        default:
+            jassertfalse; // Invalid filter type
+            return {};
+        }
+    }
+
+    switch (chainSettings.filterName[band])
+    {
+    case PeakFilter:
+        return calculatePeakFilter(sampleRate,
+            frequency,
+            quality,
+            juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels[band]));
+    case NotchFilter:
+        return calculateNotch(sampleRate, frequency, quality);
+    case BandPassFilter:
+        return calculateBandPass(sampleRate, frequency, quality);
+    default:
+        jassertfalse; // Invalid filter type
+        return {};
+    }
+}
+
+void calculateChainCoefficients(ChainCoefficients& destination,
+    const ChainSettings& chainSettings,
+    double sampleRate,
+    int stages) noexcept
+{
+    if (stages & LowCutDirty)
+        destination.lowCut = calculateLowCutCoefficients(chainSettings, sampleRate);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (stages & getBandDirtyBit(band))
+        {
+            destination.bands[band] = calculateBandCoefficients(chainSettings, band, sampleRate);
+            destination.bandEnabled[band] = chainSettings.bandEnabled[band];
+        }
+    }
+
+    if (stages & HighCutDirty)
+        destination.highCut = calculateHighCutCoefficients(chainSettings, sampleRate);
+}
+
+// |H|^2 of a biquad as a ratio of quadratics in phi = sin^2(w / 2).
+static double getMagnitudeSquared(const BiquadCoefficients& section, double phi) noexcept
+{
+    double b0 = section.b0, b1 = section.b1, b2 = section.b2;
+    double a1 = section.a1, a2 = section.a2;
+
+    auto bSum = b0 + b1 + b2;
+    auto aSum = 1.0 + a1 + a2;
+
+    auto numerator = bSum * bSum + phi * (-4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2) + phi * 16.0 * b0 * b2);
+    auto denominator = aSum * aSum + phi * (-4.0 * (a1 + 4.0 * a2 + a1 * a2) + phi * 16.0 * a2);
+
+    return juce::jmax(0.0, numerator) / denominator;
+}
+
+double getChainMagnitude(const ChainCoefficients& coefficients, double frequency, double sampleRate) noexcept
+{
+    auto sine = std::sin(juce::MathConstants<double>::pi * frequency / sampleRate);
+    auto phi = sine * sine;
+
+    auto magnitudeSquared = 1.0;
+
+    for (int band = 0; band < maxBands; ++band)
+        if (coefficients.bandEnabled[band])
+            magnitudeSquared *= getMagnitudeSquared(coefficients.bands[band], phi);
+
+    for (int i = 0; i < coefficients.lowCut.numSections; ++i)
+        magnitudeSquared *= getMagnitudeSquared(coefficients.lowCut.sections[i], phi);
+
+    for (int i = 0; i < coefficients.highCut.numSections; ++i)
+        magnitudeSquared *= getMagnitudeSquared(coefficients.highCut.sections[i], phi);
+
+    return std::sqrt(magnitudeSquared);
+}
+
+// Largest pole radius of 1 / (1 + a1 z^-1 + a2 z^-2).
+static double getPoleRadius(const BiquadCoefficients& section) noexcept
+{
+    auto discriminant = section.a1 * section.a1 - 4.0 * section.a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt(section.a2); // Complex pair: |p|^2 = a2
+
+    auto root = std::sqrt(discriminant);
+    return juce::jmax(std::abs(-section.a1 + root), std::abs(-section.a1 - root)) * 0.5;
+}
+
+static BiquadCoefficients interpolate(const BiquadCoefficients& a, const BiquadCoefficients& b, double position) noexcept
+{
+    return { a.b0 + (b.b0 - a.b0) * position,
+             a.b1 + (b.b1 - a.b1) * position,
+             a.b2 + (b.b2 - a.b2) * position,
+             a.a1 + (b.a1 - a.a1) * position,
+             a.a2 + (b.a2 - a.a2) * position };
+}
+
+static void interpolateCut(CutCoefficients& destination, const CutCoefficients& a, const CutCoefficients& b, double position) noexcept
+{
+    destination.numSections = juce::jmax(a.numSections, b.numSections);
+
+    for (int i = 0; i < destination.numSections; ++i)
+    {
+        auto sectionA = i < a.numSections ? a.sections[i] : BiquadCoefficients();
+        auto sectionB = i < b.numSections ? b.sections[i] : BiquadCoefficients();
+        destination.sections[i] = interpolate(sectionA, sectionB, position);
+    }
+}
+
+void interpolateChainCoefficients(ChainCoefficients& destination,
+    const ChainCoefficients& a,
+    const ChainCoefficients& b,
+    double position) noexcept
+{
+    interpolateCut(destination.lowCut, a.lowCut, b.lowCut, position);
+    interpolateCut(destination.highCut, a.highCut, b.highCut, position);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        destination.bandEnabled[band] = a.bandEnabled[band] || b.bandEnabled[band];
+
+        // Disabled bands hold pass through coefficients.
+        destination.bands[band] = destination.bandEnabled[band] ? interpolate(a.bands[band], b.bands[band], position)
+                                                                : BiquadCoefficients();
+    }
+}
+
+int getChainRingDownSamples(const ChainCoefficients& coefficients, double sampleRate, double attenuationInDecibels) noexcept
+{
+    auto maxSamples = maxRingDownSeconds * sampleRate;
+    auto radius = 0.0;
+
+    auto addSection = [&radius](const BiquadCoefficients& section) { radius = juce::jmax(radius, getPoleRadius(section)); };
+
+    for (int i = 0; i < coefficients.lowCut.numSections; ++i)
+        addSection(coefficients.lowCut.sections[i]);
+
+    for (int band = 0; band < maxBands; ++band)
+        if (coefficients.bandEnabled[band])
+            addSection(coefficients.bands[band]);
+
+    for (int i = 0; i < coefficients.highCut.numSections; ++i)
+        addSection(coefficients.highCut.sections[i]);
+
+    if (radius >= 1.0)
+        return static_cast<int>(maxSamples);
+
+    if (radius <= 0.0)
+        return 2; // FIR sections only: gone once the delay line has emptied
+
+    // r^n = 10^(-attenuation / 20)
+    auto samples = -attenuationInDecibels / 20.0 * std::log(10.0) / std::log(radius);
+
+    return static_cast<int>(std::ceil(juce::jmin(samples, maxSamples)));
+}
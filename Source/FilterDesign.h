@@ -0,0 +1,304 @@
+/*
+  ==============================================================================
+
+    FilterDesign.h
+    Parameter snapshot, filter chain types and coefficient design helpers
+    shared by the processor, the coefficient designer and the editor.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+enum Slope {
+	Slope_12,
+	Slope_24,
+	Slope_36,
+	Slope_48
+};
+
+enum FilterType
+{
+	PeakFilter,
+	NotchFilter,
+	BandPassFilter
+};
+
+// Which filter structure runs the chain, see the "Engine" parameter.
+enum FilterEngine
+{
+    BiquadEngine,
+    TPTEngine,
+    LinearPhaseEngine
+};
+
+// How the biquads' coefficients are worked out from the analog prototypes,
+// see the "Design" parameter. BilinearDesign is the RBJ and Butterworth
+// designs, whose response is cramped towards Nyquist. MatchedDesign matches
+// the analog magnitude instead (M. Vicanek, "Matched Second Order Digital
+// Filters", 2016), so bands near Nyquist keep their shape without
+// oversampling. The TPT engine always uses its own prewarped design.
+enum DesignMethod
+{
+    BilinearDesign,
+    MatchedDesign
+};
+
+// How the first two channels are split between the two filter paths, see
+// the "Stereo Mode" parameter. In StereoLinked every channel runs path A;
+// otherwise path A filters left (or mid) and path B right (or side). Any
+// further channels always run path A.
+enum StereoMode
+{
+    StereoLinked,
+    LeftRight,
+    MidSide
+};
+
+enum ChainPath
+{
+    PathA,
+    PathB,
+    numChainPaths
+};
+
+// Number of parametric bands between the cut filters. Band 0 is the one the
+// plugin always had, and keeps its original parameter IDs.
+constexpr int maxBands = 16;
+
+// The parametric bands are stored as structure of arrays: band i is element i
+// of every per band array.
+struct ChainSettings
+{
+	std::array<float, maxBands> peakFreq{}, peakGainInDecibels{}, peakQuality{};
+	std::array<int, maxBands> filterName{};
+	std::array<bool, maxBands> bandEnabled{};
+	float lowCutFreq{ 0 }, highCutFreq{ 0 };
+	int lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+    // Shared by both paths. Not stored in snapshots or set by
+    // setChainSettings(): it is one global parameter.
+    int designMethod{ BilinearDesign };
+};
+
+inline bool operator==(const ChainSettings& lhs, const ChainSettings& rhs) noexcept
+{
+    return lhs.peakFreq == rhs.peakFreq
+        && lhs.peakGainInDecibels == rhs.peakGainInDecibels
+        && lhs.peakQuality == rhs.peakQuality
+        && lhs.filterName == rhs.filterName
+        && lhs.bandEnabled == rhs.bandEnabled
+        && lhs.lowCutFreq == rhs.lowCutFreq
+        && lhs.highCutFreq == rhs.highCutFreq
+        && lhs.lowCutSlope == rhs.lowCutSlope
+        && lhs.highCutSlope == rhs.highCutSlope
+        && lhs.designMethod == rhs.designMethod;
+}
+
+inline bool operator!=(const ChainSettings& lhs, const ChainSettings& rhs) noexcept
+{
+    return !(lhs == rhs);
+}
+
+// Path B has its own copy of every filter parameter, with " B" appended to
+// the path A parameter ID.
+juce::String getParameterID(const juce::String& pathAParameterID, int path);
+int getChainPathForParameter(const juce::String& parameterID);
+
+// Bands after the first have their number (from 2) appended to band 0's
+// parameter ID, e.g. "Peak Freq 2".
+juce::String getBandParameterID(const juce::String& band0ParameterID, int band);
+int getBandForParameter(const juce::String& parameterID);
+
+/**
+    The raw parameter values behind one path's ChainSettings, looked up once
+    so that reading the settings on the audio thread involves no ID lookups
+    or allocations.
+*/
+class ChainParameters
+{
+public:
+    ChainParameters(juce::AudioProcessorValueTreeState& apvts, int path);
+
+    ChainSettings load() const noexcept;
+
+    // Sets the field of `settings` behind `parameter` to `value`, as load()
+    // would have read it. Returns the DirtyStages that depend on it, or 0 if
+    // the parameter isn't one of this path's.
+    int apply(ChainSettings& settings, const std::atomic<float>* parameter, float value) const noexcept;
+
+private:
+    std::atomic<float>* lowCutFreq;
+    std::atomic<float>* highCutFreq;
+    std::atomic<float>* lowCutSlope;
+    std::atomic<float>* highCutSlope;
+
+    std::array<std::atomic<float>*, maxBands> peakFreq, peakGain, peakQuality, filterName, bandEnabled;
+
+    std::atomic<float>* designMethod;
+};
+
+// Looks every parameter up by ID. Use a ChainParameters on the audio thread.
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts, int path = PathA);
+
+// Sets every one of the path's filter parameters, notifying the host, e.g.
+// to recall a snapshot. Message thread.
+void setChainSettings(juce::AudioProcessorValueTreeState& apvts, const ChainSettings& chainSettings, int path = PathA);
+StereoMode getStereoMode(juce::AudioProcessorValueTreeState& apvts);
+FilterEngine getFilterEngine(juce::AudioProcessorValueTreeState& apvts);
+
+// The settings as the engine realises them. The TPT engine's prewarped
+// response is the bilinear one whatever "Design" says, so anything drawn or
+// measured for it must use BilinearDesign.
+ChainSettings getEngineChainSettings(ChainSettings chainSettings, FilterEngine engine);
+
+// The processor runs in whichever precision the host asks for, so the JUCE
+// filter types and designs are generic over the sample type. They are
+// instantiated for float and double in FilterDesign.cpp.
+template <typename SampleType>
+using Filter = juce::dsp::IIR::Filter<SampleType>;
+
+// One bit per stage that can be redesigned on its own: the two cut filters
+// and each parametric band.
+enum DirtyStages
+{
+    LowCutDirty = 1 << 0,
+    HighCutDirty = 1 << 1,
+    firstBandDirtyBit = 2,
+    AllBandsDirty = ((1 << maxBands) - 1) << firstBandDirtyBit,
+    AllStagesDirty = LowCutDirty | HighCutDirty | AllBandsDirty
+};
+
+constexpr int getBandDirtyBit(int band) noexcept
+{
+    return 1 << (firstBandDirtyBit + band);
+}
+
+// Returns the chain stages whose coefficients depend on the given parameter.
+int getDirtyStagesForParameter(const juce::String& parameterID);
+
+template <typename SampleType>
+using Coefficients = typename Filter<SampleType>::CoefficientsPtr;
+
+template <typename SampleType>
+Coefficients<SampleType> makePeakFilter(const ChainSettings& chainSettings, int band, double sampleRate);
+template <typename SampleType>
+Coefficients<SampleType> makeNotchFilter(const ChainSettings& chainSettings, int band, double sampleRate);
+template <typename SampleType>
+Coefficients<SampleType> makeBandPassFilter(const ChainSettings& chainSettings, int band, double sampleRate);
+
+template <typename SampleType>
+Coefficients<SampleType> makeBandFilter(const ChainSettings& chainSettings, int band, double sampleRate);
+
+template <typename SampleType>
+auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+	return juce::dsp::FilterDesign<SampleType>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
+        sampleRate,
+        2 * (chainSettings.lowCutSlope + 1));
+}
+
+template <typename SampleType>
+auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
+{
+    return juce::dsp::FilterDesign<SampleType>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
+        sampleRate,
+        2 * (chainSettings.highCutSlope + 1));
+}
+
+//==============================================================================
+// Plain, allocation free copies of designed coefficients. Unlike
+// IIR::Coefficients these can be handed to the audio thread by value.
+// Always double: the float engines round them once when they are loaded,
+// and the double engines keep the precision that deep, low cutoffs at high
+// sample rates need.
+struct BiquadCoefficients
+{
+    double b0{ 1.0 }, b1{ 0.0 }, b2{ 0.0 }, a1{ 0.0 }, a2{ 0.0 };
+};
+
+struct CutCoefficients
+{
+    std::array<BiquadCoefficients, 4> sections;
+    int numSections{ 1 };
+};
+
+// Disabled bands keep pass through coefficients and are skipped entirely by
+// the filter chains and the magnitude evaluations.
+struct ChainCoefficients
+{
+    CutCoefficients lowCut, highCut;
+    std::array<BiquadCoefficients, maxBands> bands;
+    std::array<bool, maxBands> bandEnabled{};
+};
+
+using PathCoefficients = std::array<ChainCoefficients, numChainPaths>;
+
+template <typename SampleType>
+BiquadCoefficients toBiquadCoefficients(const juce::dsp::IIR::Coefficients<SampleType>& coefficients);
+
+// Uncached designs of the individual stages. These allocate, so they must
+// never be called on the audio thread. The MatchedDesign ones are the
+// allocation free calculations below.
+CutCoefficients designLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate);
+CutCoefficients designHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate);
+BiquadCoefficients designBandCoefficients(const ChainSettings& chainSettings, int band, double sampleRate);
+
+// Redesigns the given DirtyStages of `destination`, leaving the others untouched.
+// Allocates, so it must never be called on the audio thread.
+void designChainCoefficients(ChainCoefficients& destination,
+    const ChainSettings& chainSettings,
+    double sampleRate,
+    int stages);
+
+//==============================================================================
+// Allocation free equivalents of the JUCE designs above, computed directly into
+// plain coefficients. Cheap enough to call on the audio thread, e.g. for the
+// sub-block updates made while parameters are being smoothed.
+BiquadCoefficients calculateLowPass(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculateHighPass(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculatePeakFilter(double sampleRate, float frequency, float quality, float gainFactor) noexcept;
+BiquadCoefficients calculateNotch(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculateBandPass(double sampleRate, float frequency, float quality) noexcept;
+
+// The MatchedDesign equivalents. The poles are the analog ones mapped by
+// z = exp(sT); the zeros are fitted so the magnitude matches the analog
+// prototype's at DC, the centre frequency and Nyquist. The notch keeps its
+// zeros exactly on the unit circle at the centre frequency instead.
+BiquadCoefficients calculateMatchedLowPass(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculateMatchedHighPass(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculateMatchedPeakFilter(double sampleRate, float frequency, float quality, float gainFactor) noexcept;
+BiquadCoefficients calculateMatchedNotch(double sampleRate, float frequency, float quality) noexcept;
+BiquadCoefficients calculateMatchedBandPass(double sampleRate, float frequency, float quality) noexcept;
+
+CutCoefficients calculateLowCutCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept;
+CutCoefficients calculateHighCutCoefficients(const ChainSettings& chainSettings, double sampleRate) noexcept;
+BiquadCoefficients calculateBandCoefficients(const ChainSettings& chainSettings, int band, double sampleRate) noexcept;
+
+void calculateChainCoefficients(ChainCoefficients& destination,
+    const ChainSettings& chainSettings,
+    double sampleRate,
+    int stages) noexcept;
+
+// Linear interpolation, `position` from 0 (a) to 1 (b), of every section.
+// A second order section is stable on a convex set of (a1, a2), so sections
+// between two stable ones are stable too. A cut filter with fewer sections
+// is padded with pass through ones, and a band on at only one end runs from
+// pass through. Cheap enough for the audio thread.
+void interpolateChainCoefficients(ChainCoefficients& destination,
+    const ChainCoefficients& a,
+    const ChainCoefficients& b,
+    double position) noexcept;
+
+// Number of samples the chain's slowest pole takes to decay by
+// `attenuationInDecibels`, from the poles of every section in use. Capped at
+// maxRingDownSeconds, which is also what an unstable or marginal section
+// returns.
+constexpr double maxRingDownSeconds = 10.0;
+int getChainRingDownSamples(const ChainCoefficients& coefficients, double sampleRate, double attenuationInDecibels) noexcept;
+
+// Magnitude of the whole chain at one frequency. See ResponseCurve for the
+// vectorised version used for drawing.
+double getChainMagnitude(const ChainCoefficients& coefficients, double frequency, double sampleRate) noexcept;
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    LinearPhaseDesigner.cpp
+    Designs the linear phase FIR kernel away from the audio thread.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseDesigner.h"
+
+LinearPhaseDesigner::LinearPhaseDesigner(juce::AudioProcessorValueTreeState& state, MultiChannelConvolution& c)
+    : apvts(state),
+      convolution(c),
+      engineParameter(state.getRawParameterValue("Engine"))
+{
+}
+
+LinearPhaseDesigner::~LinearPhaseDesigner()
+{
+    release();
+}
+
+void LinearPhaseDesigner::prepare(double newSampleRate, double newDesignSampleRate)
+{
+    release();
+
+    {
+        const juce::ScopedLock sl(designLock);
+
+        sampleRate = newSampleRate;
+        designSampleRate = newDesignSampleRate;
+
+        auto fftOrder = juce::jmax(8, juce::roundToInt(std::ceil(std::log2(kernelSeconds * sampleRate))));
+        kernelSize = 1 << fftOrder;
+
+        fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+        window = std::make_unique<juce::dsp::WindowingFunction<float>>(static_cast<size_t>(kernelSize) + 1,
+                                                                      juce::dsp::WindowingFunction<float>::blackman,
+                                                                      false);
+        spectrum.assign(static_cast<size_t>(2 * kernelSize), 0.f);
+    }
+
+    // Offline renders filter their first block with this kernel, so it is
+    // installed now rather than crossfaded in once the Convolution's own
+    // thread has loaded it.
+    dirty.store(true);
+
+    if (designPendingKernel())
+        convolution.finishLoading();
+
+    worker->addClient(*this);
+}
+
+void LinearPhaseDesigner::release()
+{
+    worker->removeClient(*this);
+}
+
+void LinearPhaseDesigner::markDirty() noexcept
+{
+    // A kernel already dirty has a design on its way, or is waiting for
+    // the engine to switch to linear phase.
+    if (!dirty.exchange(true) && isLinearPhaseSelected())
+        worker->requestDesign(*this);
+}
+
+void LinearPhaseDesigner::engineChanged() noexcept
+{
+    if (isLinearPhaseSelected() && dirty.load())
+        worker->requestDesign(*this);
+}
+
+bool LinearPhaseDesigner::isLinearPhaseSelected() const noexcept
+{
+    return static_cast<int>(engineParameter->load()) == LinearPhaseEngine;
+}
+
+bool LinearPhaseDesigner::designPendingKernel()
+{
+    // Left dirty while another engine runs, so switching to linear phase
+    // designs straight away.
+    if (!isLinearPhaseSelected() || !dirty.exchange(false))
+        return false;
+
+    const juce::ScopedLock sl(designLock);
+
+    // A second channel carries path B's kernel while the paths are split.
+    auto numPaths = getStereoMode(apvts) != StereoLinked ? 2 : 1;
+    juce::AudioBuffer<float> kernel(numPaths, kernelSize);
+
+    for (int path = 0; path < numPaths; ++path)
+        designKernel(kernel, path);
+
+    convolution.loadImpulseResponse(std::move(kernel), sampleRate);
+    return true;
+}
+
+void LinearPhaseDesigner::designKernel(juce::AudioBuffer<float>& kernel, int path)
+{
+    ChainCoefficients coefficients;
+    calculateChainCoefficients(coefficients, getChainSettings(apvts, path), designSampleRate, AllStagesDirty);
+
+    // Zero phase spectrum: real magnitudes, no imaginary part.
+    std::fill(spectrum.begin(), spectrum.end(), 0.f);
+
+    for (int bin = 0; bin <= kernelSize / 2; ++bin)
+    {
+        auto frequency = sampleRate * bin / kernelSize;
+        spectrum[static_cast<size_t>(2 * bin)] = static_cast<float>(getChainMagnitude(coefficients, frequency, designSampleRate));
+    }
+
+    fft->performRealOnlyInverseTransform(spectrum.data());
+
+    // The zero phase impulse is centred on sample 0; rotating it by half the
+    // kernel centres it on kernelSize / 2. Sample 0 has no partner on the
+    // other side, so it is left at zero to keep the kernel exactly symmetric.
+    auto* output = kernel.getWritePointer(path);
+    auto half = kernelSize / 2;
+
+    output[0] = 0.f;
+
+    for (int i = 1; i < kernelSize; ++i)
+        output[i] = spectrum[static_cast<size_t>((i + half) % kernelSize)];
+
+    // A symmetric window of kernelSize + 1 points peaks on the centre tap.
+    window->multiplyWithWindowingTable(output, static_cast<size_t>(kernelSize));
+}
+
+void LinearPhaseDesigner::designPending()
+{
+    designPendingKernel();
+}
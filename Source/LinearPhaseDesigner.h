@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    LinearPhaseDesigner.h
+    Designs the linear phase FIR kernel away from the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+#include "MultiChannelConvolution.h"
+#include "DesignWorker.h"
+
+/**
+    Turns the current ChainSettings into a linear phase FIR kernel with the
+    same magnitude response as the IIR chain, and loads it into a
+    MultiChannelConvolution.
+
+    The magnitude is sampled on the FFT grid, inverse transformed as a zero
+    phase spectrum, rotated by half the kernel size and windowed, so the
+    kernel is symmetric and delays everything by exactly getKernelLatency()
+    samples. While the "Stereo Mode" splits the paths, the kernel has a
+    second channel for path B.
+
+    Designs run on the shared DesignWorker thread, and only while the
+    "Engine" parameter selects the linear phase engine. The convolutions swap kernels
+    without blocking the audio thread and crossfades from the old one.
+*/
+class LinearPhaseDesigner : private DesignWorker::Client
+{
+public:
+    LinearPhaseDesigner(juce::AudioProcessorValueTreeState& apvts, MultiChannelConvolution& convolution);
+    ~LinearPhaseDesigner() override;
+
+    // Sizes the kernel for the sample rate, designs and installs it
+    // synchronously if the linear phase engine is selected, then registers
+    // with the worker.
+    // The IIR prototype is designed at `designSampleRate` (the oversampled
+    // rate, if any) so the kernel follows the uncramped response near Nyquist.
+    // Call after convolution.prepare(), while the audio thread is not processing.
+    // release() must come before convolution.prepare(), which may add or
+    // remove the convolutions the worker loads kernels into.
+    void prepare(double sampleRate, double designSampleRate);
+    void release();
+
+    // May be called from any thread including the audio thread. Only wakes
+    // the worker if the kernel wasn't already dirty and the linear phase
+    // engine is selected; otherwise the change waits for engineChanged().
+    void markDirty() noexcept;
+
+    // Call when the "Engine" parameter changes. Wakes the worker if the
+    // kernel went dirty while another engine was selected.
+    void engineChanged() noexcept;
+
+    // Delay of the kernel itself; the Convolution may add its own latency.
+    int getKernelLatency() const noexcept { return kernelSize / 2; }
+    int getKernelSize() const noexcept { return kernelSize; }
+
+private:
+    void designPending() override;
+
+    bool isLinearPhaseSelected() const noexcept;
+    // Returns true if a kernel was designed and handed to the convolution.
+    bool designPendingKernel();
+    void designKernel(juce::AudioBuffer<float>& kernel, int path);
+
+    // About 170 ms: long enough to resolve the cut filters down to 20 Hz.
+    static constexpr double kernelSeconds = 0.17;
+
+    juce::AudioProcessorValueTreeState& apvts;
+    MultiChannelConvolution& convolution;
+    juce::SharedResourcePointer<DesignWorker> worker;
+
+    std::atomic<float>* engineParameter;
+    std::atomic<bool> dirty{ true };
+
+    juce::CriticalSection designLock;
+    double sampleRate{ 44100.0 }, designSampleRate{ 44100.0 };
+    int kernelSize{ 0 };
+    std::unique_ptr<juce::dsp::FFT> fft;
+    std::unique_ptr<juce::dsp::WindowingFunction<float>> window;
+    std::vector<float> spectrum;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseDesigner)
+};
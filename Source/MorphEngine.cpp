@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    MorphEngine.cpp
+    Snapshot slots of the filter settings, and the precomputed coefficient
+    paths the processor morphs between them along.
+
+  ==============================================================================
+*/
+
+#include "MorphEngine.h"
+
+namespace
+{
+    float interpolateLinear(float a, float b, float position) noexcept
+    {
+        return a + (b - a) * position;
+    }
+
+    float interpolateLog(float a, float b, float position) noexcept
+    {
+        return std::exp(interpolateLinear(std::log(a), std::log(b), position));
+    }
+
+    template<typename Value>
+    Value interpolateSwitch(Value a, Value b, float position) noexcept
+    {
+        return position < 0.5f ? a : b;
+    }
+}
+
+ChainSettings interpolateChainSettings(const ChainSettings& a, const ChainSettings& b, float position) noexcept
+{
+    ChainSettings settings;
+
+    settings.lowCutFreq = interpolateLog(a.lowCutFreq, b.lowCutFreq, position);
+    settings.highCutFreq = interpolateLog(a.highCutFreq, b.highCutFreq, position);
+    settings.lowCutSlope = interpolateSwitch(a.lowCutSlope, b.lowCutSlope, position);
+    settings.highCutSlope = interpolateSwitch(a.highCutSlope, b.highCutSlope, position);
+    settings.designMethod = interpolateSwitch(a.designMethod, b.designMethod, position);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto onAtA = a.bandEnabled[band];
+        auto onAtB = b.bandEnabled[band];
+
+        if (onAtA && onAtB)
+        {
+            settings.bandEnabled[band] = true;
+            settings.filterName[band] = interpolateSwitch(a.filterName[band], b.filterName[band], position);
+            settings.peakFreq[band] = interpolateLog(a.peakFreq[band], b.peakFreq[band], position);
+            settings.peakQuality[band] = interpolateLog(a.peakQuality[band], b.peakQuality[band], position);
+            settings.peakGainInDecibels[band] = interpolateLinear(a.peakGainInDecibels[band], b.peakGainInDecibels[band], position);
+            continue;
+        }
+
+        // Off at both ends, or on at one: the band keeps the settings of the
+        // end it is on at.
+        const auto& on = onAtA ? a : b;
+
+        settings.filterName[band] = on.filterName[band];
+        settings.peakFreq[band] = on.peakFreq[band];
+        settings.peakQuality[band] = on.peakQuality[band];
+        settings.peakGainInDecibels[band] = on.peakGainInDecibels[band];
+        settings.bandEnabled[band] = interpolateSwitch(onAtA, onAtB, position);
+
+        if ((onAtA || onAtB) && on.filterName[band] == PeakFilter)
+        {
+            // A peak at 0 dB is the band switched off, so it can fade.
+            settings.bandEnabled[band] = true;
+            settings.peakGainInDecibels[band] = interpolateLinear(onAtA ? a.peakGainInDecibels[band] : 0.f,
+                                                                  onAtB ? b.peakGainInDecibels[band] : 0.f,
+                                                                  position);
+        }
+    }
+
+    return settings;
+}
+
+void MorphEngine::storeSnapshot(int slot, const ChainSnapshot& snapshot)
+{
+    jassert(juce::isPositiveAndBelow(slot, numSnapshots));
+
+    const juce::ScopedLock lock(snapshotLock);
+    snapshots[static_cast<size_t>(slot)] = snapshot;
+}
+
+std::optional<ChainSnapshot> MorphEngine::getSnapshot(int slot) const
+{
+    if (!juce::isPositiveAndBelow(slot, numSnapshots))
+        return {};
+
+    const juce::ScopedLock lock(snapshotLock);
+    return snapshots[static_cast<size_t>(slot)];
+}
+
+SnapshotBank MorphEngine::getSnapshots() const
+{
+    const juce::ScopedLock lock(snapshotLock);
+    return snapshots;
+}
+
+void MorphEngine::setSnapshots(const SnapshotBank& newSnapshots)
+{
+    const juce::ScopedLock lock(snapshotLock);
+    snapshots = newSnapshots;
+}
+
+void MorphEngine::startMorph(const ChainSnapshot& start, const ChainSnapshot& target, double seconds, double sampleRate)
+{
+    auto& path = paths.getWriteBuffer();
+
+    auto numSegments = juce::jlimit(1, maxKeyframes - 1, static_cast<int>(seconds / minKeyframeSeconds));
+
+    path.numKeyframes = numSegments + 1;
+    path.samplesPerKeyframe = juce::jmax(1.0, seconds * sampleRate / numSegments);
+    path.sampleRate = sampleRate;
+
+    for (int keyframe = 0; keyframe < path.numKeyframes; ++keyframe)
+    {
+        auto position = static_cast<float>(keyframe) / static_cast<float>(numSegments);
+
+        for (int chainPath = 0; chainPath < numChainPaths; ++chainPath)
+        {
+            auto& settings = path.settings[static_cast<size_t>(keyframe)][static_cast<size_t>(chainPath)];
+            settings = interpolateChainSettings(start[chainPath], target[chainPath], position);
+
+            // Fresh coefficients, so unused cut sections are pass through.
+            auto& coefficients = path.keyframes[static_cast<size_t>(keyframe)][static_cast<size_t>(chainPath)];
+            coefficients = ChainCoefficients();
+
+            calculateChainCoefficients(coefficients, settings, sampleRate, AllStagesDirty);
+        }
+    }
+
+    morphStart = start;
+    morphTarget = target;
+    progress.store(0.f, std::memory_order_relaxed);
+
+    paths.publish();
+}
+
+ChainSnapshot MorphEngine::getCurrentSettings(const ChainSnapshot& settled) const
+{
+    auto position = progress.load(std::memory_order_relaxed);
+
+    if (position >= 1.f)
+        return settled;
+
+    ChainSnapshot current;
+
+    for (int path = 0; path < numChainPaths; ++path)
+        current[path] = interpolateChainSettings(morphStart[path], morphTarget[path], position);
+
+    return current;
+}
@@ -0,0 +1,96 @@
+/*
+  ==============================================================================
+
+    MorphEngine.h
+    Snapshot slots of the filter settings, and the precomputed coefficient
+    paths the processor morphs between them along.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <optional>
+
+#include "FilterDesign.h"
+#include "TripleBuffer.h"
+
+// Both paths' settings, as stored in a snapshot slot.
+using ChainSnapshot = std::array<ChainSettings, numChainPaths>;
+
+constexpr int numSnapshots = 8;
+using SnapshotBank = std::array<std::optional<ChainSnapshot>, numSnapshots>;
+
+// Settings `position` of the way from `a` to `b`, in a perceptual domain:
+// frequencies and Q move in log space and gains in dB. Types, slopes and
+// on/off switch half way, except that a peak band on at only one end fades
+// from 0 dB instead.
+ChainSettings interpolateChainSettings(const ChainSettings& a, const ChainSettings& b, float position) noexcept;
+
+/**
+    Holds the snapshot slots and stages each morph ahead of time.
+
+    startMorph() runs on the message thread. It designs up to maxKeyframes
+    sets of coefficients, evenly spaced in time, from settings interpolated
+    with interpolateChainSettings(), keeps those settings alongside, and
+    hands both to the audio thread through a TripleBuffer. While the morph
+    runs, the audio thread only interpolates between neighbouring keyframes:
+    the biquads' coefficients linearly (see interpolateChainCoefficients()),
+    and the TPT engine's settings, which it turns into g and k itself. It
+    neither designs nor allocates.
+
+    The keyframes are at least minKeyframeSeconds apart, which is fine
+    enough that the coefficient interpolation between them stays close to
+    the perceptual path. It also smooths the switched settings over one
+    keyframe.
+*/
+class MorphEngine
+{
+public:
+    static constexpr int maxKeyframes = 128;
+    static constexpr double minKeyframeSeconds = 0.005;
+
+    struct MorphPath
+    {
+        MorphPath() : keyframes(static_cast<size_t>(maxKeyframes)), settings(static_cast<size_t>(maxKeyframes)) {}
+
+        std::vector<PathCoefficients> keyframes;
+        // The settings each keyframe was designed from.
+        std::vector<ChainSnapshot> settings;
+        int numKeyframes{ 0 };
+        double samplesPerKeyframe{ 1.0 };
+        double sampleRate{ 0.0 };
+    };
+
+    // Any thread but the audio thread.
+    void storeSnapshot(int slot, const ChainSnapshot& snapshot);
+    std::optional<ChainSnapshot> getSnapshot(int slot) const;
+    SnapshotBank getSnapshots() const;
+    void setSnapshots(const SnapshotBank& newSnapshots);
+
+    // Message thread. Designs the path from `start` to `target`, taking
+    // `seconds` at the filters' `sampleRate`, and publishes it.
+    void startMorph(const ChainSnapshot& start, const ChainSnapshot& target, double seconds, double sampleRate);
+
+    // Message thread. Where the filters are now: along the last morph,
+    // according to the audio thread's progress, or `settled` once it ended.
+    ChainSnapshot getCurrentSettings(const ChainSnapshot& settled) const;
+
+    // Audio thread. The newest morph, or nullptr if none was started since
+    // the last call. It stays valid until the next non-null return.
+    const MorphPath* acquireMorph() noexcept { return paths.acquire(); }
+
+    // Audio thread. How far along the current morph is, from 0 to 1.
+    void setProgress(float newProgress) noexcept { progress.store(newProgress, std::memory_order_relaxed); }
+
+private:
+    TripleBuffer<MorphPath> paths;
+    std::atomic<float> progress{ 1.f };
+
+    // The message thread's copy of the last morph's ends.
+    ChainSnapshot morphStart, morphTarget;
+
+    juce::CriticalSection snapshotLock;
+    SnapshotBank snapshots;
+};
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    MultiChannelConvolution.cpp
+
+  ==============================================================================
+*/
+
+#include "MultiChannelConvolution.h"
+
+void MultiChannelConvolution::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    auto numPairs = juce::jmax(static_cast<size_t>(1),
+                               (static_cast<size_t>(spec.numChannels) + channelsPerConvolution - 1) / channelsPerConvolution);
+
+    // Existing instances keep their kernel, so only new pairs need one.
+    while (convolutions.size() < numPairs)
+        convolutions.push_back(std::make_unique<juce::dsp::Convolution>());
+
+    convolutions.resize(numPairs);
+
+    pairSpec = spec;
+    pairSpec.numChannels = static_cast<juce::uint32>(juce::jmin(static_cast<int>(spec.numChannels), channelsPerConvolution));
+
+    for (auto& convolution : convolutions)
+        convolution->prepare(pairSpec);
+}
+
+void MultiChannelConvolution::reset() noexcept
+{
+    for (auto& convolution : convolutions)
+        convolution->reset();
+}
+
+void MultiChannelConvolution::process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    auto numChannels = block.getNumChannels();
+
+    jassert(numChannels <= convolutions.size() * channelsPerConvolution);
+
+    for (size_t pair = 0; pair * channelsPerConvolution < numChannels; ++pair)
+    {
+        auto firstChannel = pair * channelsPerConvolution;
+        auto pairBlock = block.getSubsetChannelBlock(firstChannel,
+                                                     juce::jmin(numChannels - firstChannel, static_cast<size_t>(channelsPerConvolution)));
+        juce::dsp::ProcessContextReplacing<float> pairContext(pairBlock);
+        pairContext.isBypassed = context.isBypassed;
+
+        auto midSide = pair == 0 && stereoMode == MidSide && pairBlock.getNumChannels() == 2 && !context.isBypassed;
+
+        if (midSide)
+            encodeMidSide(pairBlock);
+
+        convolutions[pair]->process(pairContext);
+
+        if (midSide)
+            decodeMidSide(pairBlock);
+    }
+}
+
+void MultiChannelConvolution::encodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    auto* left = block.getChannelPointer(0);
+    auto* right = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        auto mid = 0.5f * (left[i] + right[i]);
+        auto side = 0.5f * (left[i] - right[i]);
+
+        left[i] = mid;
+        right[i] = side;
+    }
+}
+
+void MultiChannelConvolution::decodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept
+{
+    auto* mid = block.getChannelPointer(0);
+    auto* side = block.getChannelPointer(1);
+
+    for (size_t i = 0; i < block.getNumSamples(); ++i)
+    {
+        auto left = mid[i] + side[i];
+        auto right = mid[i] - side[i];
+
+        mid[i] = left;
+        side[i] = right;
+    }
+}
+
+void MultiChannelConvolution::loadImpulseResponse(juce::AudioBuffer<float>&& kernel, double kernelSampleRate)
+{
+    auto split = kernel.getNumChannels() > 1;
+
+    for (size_t i = convolutions.size(); i-- > 0;)
+    {
+        // The first pair is loaded last so it can take the buffer itself.
+        auto pairKernel = i == 0 ? std::move(kernel) : juce::AudioBuffer<float>(1, kernel.getNumSamples());
+
+        if (i != 0)
+            pairKernel.copyFrom(0, 0, kernel, 0, 0, kernel.getNumSamples());
+
+        auto stereo = i == 0 && split ? juce::dsp::Convolution::Stereo::yes : juce::dsp::Convolution::Stereo::no;
+
+        convolutions[i]->loadImpulseResponse(std::move(pairKernel),
+                                             kernelSampleRate,
+                                             stereo,
+                                             juce::dsp::Convolution::Trim::no,
+                                             juce::dsp::Convolution::Normalise::no);
+    }
+}
+
+void MultiChannelConvolution::finishLoading()
+{
+    // Convolution::prepare() runs any load still queued for its background
+    // thread, or waits for the one in progress, then installs the result
+    // as the current engine.
+    for (auto& convolution : convolutions)
+        convolution->prepare(pairSpec);
+}
+
+int MultiChannelConvolution::getLatency() const noexcept
+{
+    return convolutions.empty() ? 0 : convolutions.front()->getLatency();
+}
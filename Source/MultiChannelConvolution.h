@@ -0,0 +1,63 @@
+/*
+  ==============================================================================
+
+    MultiChannelConvolution.h
+    Runs one mono kernel over any number of channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    juce::dsp::Convolution only processes mono or stereo blocks, so wider
+    buses are split into channel pairs, each with its own Convolution. Every
+    pair is given the same kernel, so they all have the same latency and
+    crossfade to a new kernel together.
+
+    A two channel kernel holds path A and path B. The first pair then runs
+    it as a true stereo kernel, in mid/side if the StereoMode asks for it,
+    and every other pair gets path A.
+*/
+class MultiChannelConvolution
+{
+public:
+    MultiChannelConvolution() = default;
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    void process(const juce::dsp::ProcessContextReplacing<float>& context) noexcept;
+
+    // Audio thread. Only MidSide changes anything here: the first pair is
+    // encoded before and decoded after its convolution.
+    void setStereoMode(StereoMode newStereoMode) noexcept { stereoMode = newStereoMode; }
+
+    // Wait-free for the audio thread; may be called from any other thread.
+    // The kernel is copied into every pair before they all start loading it.
+    void loadImpulseResponse(juce::AudioBuffer<float>&& kernel, double kernelSampleRate);
+
+    // Finishes loading the last kernel passed to loadImpulseResponse() on the
+    // calling thread and switches to it without a crossfade, so the next
+    // block is already filtered with it. Clears the state, like prepare().
+    // Call while the audio thread is not processing.
+    void finishLoading();
+
+    int getLatency() const noexcept;
+
+private:
+    static constexpr int channelsPerConvolution = 2;
+
+    static void encodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept;
+    static void decodeMidSide(juce::dsp::AudioBlock<float>& block) noexcept;
+
+    std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+    juce::dsp::ProcessSpec pairSpec{};
+    StereoMode stereoMode{ StereoLinked };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MultiChannelConvolution)
+};
@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.cpp
+    Wait-free queue of timestamped filter parameter changes, for sample
+    accurate automation.
+
+  ==============================================================================
+*/
+
+#include "ParameterEventQueue.h"
+
+bool ParameterEventQueue::push(const ParameterEvent& event) noexcept
+{
+    if (fifo.getFreeSpace() < 1)
+        return false;
+
+    auto scope = fifo.write(1);
+    events[static_cast<size_t>(scope.startIndex1)] = event;
+
+    return true;
+}
+
+int ParameterEventQueue::pop(ParameterEvent* destination, int maxEvents) noexcept
+{
+    auto scope = fifo.read(juce::jmin(maxEvents, fifo.getNumReady()));
+
+    std::copy_n(events.begin() + scope.startIndex1, scope.blockSize1, destination);
+    std::copy_n(events.begin() + scope.startIndex2, scope.blockSize2, destination + scope.blockSize1);
+
+    return scope.blockSize1 + scope.blockSize2;
+}
@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    ParameterEventQueue.h
+    Wait-free queue of timestamped filter parameter changes, for sample
+    accurate automation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+// One filter parameter taking a new value part way through a block. The
+// parameter is identified by its raw value, as looked up once when the event
+// is scheduled, so applying it needs no ID lookups.
+struct ParameterEvent
+{
+    int sampleOffset{ 0 }; // From the start of the block, at the host rate
+    int path{ 0 };
+    const std::atomic<float>* parameter{ nullptr };
+    float value{ 0.f }; // In the parameter's own range
+};
+
+/**
+    Single producer (whichever thread calls processBlock(), just before
+    calling it), single consumer (the audio thread) queue of ParameterEvents,
+    built on juce::AbstractFifo.
+
+    The storage is allocated once, in the constructor, so neither side ever
+    allocates or waits on the other. Events that don't fit are refused.
+*/
+class ParameterEventQueue
+{
+public:
+    // More than one event every two samples of a 2048 sample block.
+    static constexpr int capacity = 1024;
+
+    ParameterEventQueue() : events(static_cast<size_t>(capacity)) {}
+
+    // Producer. Returns false if the queue is full.
+    bool push(const ParameterEvent& event) noexcept;
+
+    // Audio thread. Returns the number of events copied to `destination`.
+    int pop(ParameterEvent* destination, int maxEvents) noexcept;
+
+private:
+    juce::AbstractFifo fifo{ capacity };
+    std::vector<ParameterEvent> events;
+};
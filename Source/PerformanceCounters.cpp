@@ -0,0 +1,168 @@
+/*
+  ==============================================================================
+
+    PerformanceCounters.cpp
+    Always-on timing of the processor's and the editor's hot paths.
+
+  ==============================================================================
+*/
+
+#include "PerformanceCounters.h"
+
+namespace
+{
+    double getTicksPerSecond() noexcept
+    {
+        static const auto ticksPerSecond = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond());
+        return ticksPerSecond;
+    }
+
+    int getHistogramBin(juce::int64 ticks) noexcept
+    {
+        auto microseconds = static_cast<juce::uint64>(static_cast<double>(ticks) * 1.0e6 / getTicksPerSecond());
+        int bin = 0;
+
+        while (microseconds > 0 && bin < PerformanceCounters::numHistogramBins - 1)
+        {
+            microseconds >>= 1;
+            ++bin;
+        }
+
+        return bin;
+    }
+
+    juce::var countToVar(juce::uint64 count)
+    {
+        return static_cast<juce::int64>(count);
+    }
+}
+
+PerformanceCounters::ScopedTimer::ScopedTimer(PerformanceCounters& c, Section s) noexcept
+    : counters(c), section(s), start(juce::Time::getHighResolutionTicks())
+{
+}
+
+PerformanceCounters::ScopedTimer::~ScopedTimer()
+{
+    counters.addTime(section, juce::Time::getHighResolutionTicks() - start);
+}
+
+PerformanceCounters::ScopedBlockTimer::ScopedBlockTimer(PerformanceCounters& c, int numSamples, double sampleRate) noexcept
+    : counters(c),
+      start(juce::Time::getHighResolutionTicks()),
+      budget(sampleRate > 0.0 ? static_cast<juce::int64>(numSamples / sampleRate * getTicksPerSecond()) : 0)
+{
+}
+
+PerformanceCounters::ScopedBlockTimer::~ScopedBlockTimer()
+{
+    counters.addBlock(juce::Time::getHighResolutionTicks() - start, budget);
+}
+
+void PerformanceCounters::addTime(Section section, juce::int64 ticks) noexcept
+{
+    auto& counters = sections[static_cast<size_t>(section)];
+    auto elapsed = static_cast<juce::uint64>(juce::jmax(juce::int64(0), ticks));
+
+    increment(counters.calls, 1);
+    increment(counters.totalTicks, elapsed);
+
+    if (elapsed > counters.maxTicks.load(std::memory_order_relaxed))
+        counters.maxTicks.store(elapsed, std::memory_order_relaxed);
+}
+
+void PerformanceCounters::addBlock(juce::int64 ticks, juce::int64 budget) noexcept
+{
+    addTime(ProcessBlock, ticks);
+    increment(blockHistogram[static_cast<size_t>(getHistogramBin(ticks))], 1);
+
+    // Blocks of no samples have no budget to compare against.
+    if (budget <= 0)
+        return;
+
+    increment(budgetTicks, static_cast<juce::uint64>(budget));
+
+    auto load = static_cast<double>(ticks) / static_cast<double>(budget);
+
+    if (load > xrunRiskLoad)
+        increment(xrunRiskBlocks, 1);
+
+    if (load > maxBlockLoad.load(std::memory_order_relaxed))
+        maxBlockLoad.store(load, std::memory_order_relaxed);
+}
+
+PerformanceCounters::Snapshot PerformanceCounters::getSnapshot() const noexcept
+{
+    Snapshot snapshot;
+
+    for (size_t i = 0; i < sections.size(); ++i)
+    {
+        snapshot.sections[i].calls = sections[i].calls.load(std::memory_order_relaxed);
+        snapshot.sections[i].totalTicks = sections[i].totalTicks.load(std::memory_order_relaxed);
+        snapshot.sections[i].maxTicks = sections[i].maxTicks.load(std::memory_order_relaxed);
+    }
+
+    for (size_t i = 0; i < blockHistogram.size(); ++i)
+        snapshot.blockHistogram[i] = blockHistogram[i].load(std::memory_order_relaxed);
+
+    snapshot.budgetTicks = budgetTicks.load(std::memory_order_relaxed);
+    snapshot.xrunRiskBlocks = xrunRiskBlocks.load(std::memory_order_relaxed);
+    snapshot.coefficientRedesigns = coefficientRedesigns.load(std::memory_order_relaxed);
+    snapshot.maxBlockLoad = maxBlockLoad.load(std::memory_order_relaxed);
+
+    return snapshot;
+}
+
+double PerformanceCounters::Snapshot::getLoad() const noexcept
+{
+    if (budgetTicks == 0)
+        return 0.0;
+
+    return static_cast<double>(sections[ProcessBlock].totalTicks) / static_cast<double>(budgetTicks);
+}
+
+juce::var PerformanceCounters::Snapshot::toVar() const
+{
+    static const char* sectionNames[] = { "processBlock", "coefficientUpdate", "editorPaint" };
+    static_assert(std::size(sectionNames) == numSections, "Every section needs a name");
+
+    auto* sectionTimes = new juce::DynamicObject();
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto& times = sections[static_cast<size_t>(i)];
+
+        auto* section = new juce::DynamicObject();
+        section->setProperty("calls", countToVar(times.calls));
+        section->setProperty("totalMs", ticksToMilliseconds(times.totalTicks));
+        section->setProperty("maxMs", ticksToMilliseconds(times.maxTicks));
+        section->setProperty("meanMs", times.calls > 0 ? ticksToMilliseconds(times.totalTicks) / static_cast<double>(times.calls) : 0.0);
+        sectionTimes->setProperty(sectionNames[i], juce::var(section));
+    }
+
+    juce::Array<juce::var> histogram;
+
+    for (auto count : blockHistogram)
+        histogram.add(countToVar(count));
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty("sections", juce::var(sectionTimes));
+    root->setProperty("blockHistogramLog2Microseconds", histogram);
+    root->setProperty("load", getLoad());
+    root->setProperty("maxBlockLoad", maxBlockLoad);
+    root->setProperty("xrunRiskLoad", xrunRiskLoad);
+    root->setProperty("xrunRiskBlocks", countToVar(xrunRiskBlocks));
+    root->setProperty("coefficientRedesigns", countToVar(coefficientRedesigns));
+
+    return juce::var(root);
+}
+
+bool PerformanceCounters::writeToFile(const juce::File& file) const
+{
+    return file.replaceWithText(juce::JSON::toString(getSnapshot().toVar()));
+}
+
+double PerformanceCounters::ticksToMilliseconds(juce::uint64 ticks) noexcept
+{
+    return static_cast<double>(ticks) * 1000.0 / getTicksPerSecond();
+}
@@ -0,0 +1,125 @@
+/*
+  ==============================================================================
+
+    PerformanceCounters.h
+    Always-on timing of the processor's and the editor's hot paths.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Lock-free counters of where one plugin instance spends its time: how
+    long each timed section takes, a histogram of processBlock() times, how
+    many blocks came close to an xrun and how many coefficient sets were
+    redesigned.
+
+    Each counter has a single writing thread (the audio thread, or the
+    message thread for the editor's paint), which updates it with a relaxed
+    load and store, so recording costs two reads of the high resolution
+    clock and a few plain stores. Any thread can take a Snapshot at any time;
+    its counters may be a block apart from each other, but never torn.
+*/
+class PerformanceCounters
+{
+public:
+    enum Section
+    {
+        ProcessBlock,      // The whole of processBlock()
+        CoefficientUpdate, // Calculating and loading filter coefficients on the audio thread
+        EditorPaint,       // The response curve's paint()
+        numSections
+    };
+
+    // Bin i counts blocks that took from 2^(i - 1) to 2^i microseconds; the
+    // first bin is everything under 1 us and the last everything over 4 s.
+    static constexpr int numHistogramBins = 24;
+
+    // processBlock() calls taking longer than this fraction of the block's
+    // duration count as xrun risks: a host needs some of the budget too.
+    static constexpr double xrunRiskLoad = 0.7;
+
+    // Times its scope as one call of `section`.
+    class ScopedTimer
+    {
+    public:
+        ScopedTimer(PerformanceCounters& counters, Section section) noexcept;
+        ~ScopedTimer();
+
+    private:
+        PerformanceCounters& counters;
+        Section section;
+        juce::int64 start;
+    };
+
+    // Times its scope as one processBlock() of `numSamples` at `sampleRate`.
+    class ScopedBlockTimer
+    {
+    public:
+        ScopedBlockTimer(PerformanceCounters& counters, int numSamples, double sampleRate) noexcept;
+        ~ScopedBlockTimer();
+
+    private:
+        PerformanceCounters& counters;
+        juce::int64 start, budget;
+    };
+
+    // Audio thread. One set of redesigned coefficients loaded into the filters.
+    void countCoefficientRedesign() noexcept { increment(coefficientRedesigns, 1); }
+
+    struct SectionTimes
+    {
+        juce::uint64 calls{ 0 }, totalTicks{ 0 }, maxTicks{ 0 };
+    };
+
+    struct Snapshot
+    {
+        std::array<SectionTimes, numSections> sections;
+        std::array<juce::uint64, numHistogramBins> blockHistogram{};
+        juce::uint64 budgetTicks{ 0 }; // Sum of the timed blocks' durations
+        juce::uint64 xrunRiskBlocks{ 0 };
+        juce::uint64 coefficientRedesigns{ 0 };
+
+        // The share of the audio's duration spent in processBlock().
+        double getLoad() const noexcept;
+        double getMaxBlockLoad() const noexcept { return maxBlockLoad; }
+
+        juce::var toVar() const;
+
+    private:
+        friend class PerformanceCounters;
+        double maxBlockLoad{ 0.0 };
+    };
+
+    Snapshot getSnapshot() const noexcept;
+
+    // Writes getSnapshot() as JSON. Returns false if the file couldn't be written.
+    bool writeToFile(const juce::File& file) const;
+
+    static double ticksToMilliseconds(juce::uint64 ticks) noexcept;
+
+private:
+    struct SectionCounters
+    {
+        std::atomic<juce::uint64> calls{ 0 }, totalTicks{ 0 }, maxTicks{ 0 };
+    };
+
+    std::array<SectionCounters, numSections> sections;
+    std::array<std::atomic<juce::uint64>, numHistogramBins> blockHistogram{};
+    std::atomic<juce::uint64> budgetTicks{ 0 };
+    std::atomic<juce::uint64> xrunRiskBlocks{ 0 };
+    std::atomic<juce::uint64> coefficientRedesigns{ 0 };
+    std::atomic<double> maxBlockLoad{ 0.0 };
+
+    // Single writer, so no read-modify-write instruction is needed.
+    static void increment(std::atomic<juce::uint64>& counter, juce::uint64 amount) noexcept
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    void addTime(Section section, juce::int64 ticks) noexcept;
+    void addBlock(juce::int64 ticks, juce::int64 budget) noexcept;
+};
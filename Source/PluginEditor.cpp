@@ -9,7 +9,9 @@
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
 
-ResponseCurveComponent::ResponseCurveComponent(Project_EEAVAudioProcessor& p) : audioProcessor(p)
+ResponseCurveComponent::ResponseCurveComponent(Project_EEAVAudioProcessor& p) : audioProcessor(p),
+    preEQAnalyser(p.getPreEQFifo()),
+    postEQAnalyser(p.getPostEQFifo())
 {
     const auto& params = audioProcessor.getParameters();
     for (auto param : params)
@@ -17,6 +19,8 @@ ResponseCurveComponent::ResponseCurveComponent(Project_EEAVAudioProcessor& p) :
         param->addListener(this);
     }
 
+    audioProcessor.addAnalyserConsumer();
+
     startTimerHz(60); // Update the response curve at 60Hz
 }
 
@@ -27,6 +31,8 @@ ResponseCurveComponent::~ResponseCurveComponent()
     {
         param->removeListener(this);
     }
+
+    audioProcessor.removeAnalyserConsumer();
 }
 
 void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float newValue)
@@ -36,72 +42,46 @@ void ResponseCurveComponent::parameterValueChanged(int parameterIndex, float new
 
 void ResponseCurveComponent::timerCallback()
 {
-    if (parametersChanged.compareAndSetBool(false, true))
+    if (parametersChanged.compareAndSetBool(false, true)
+        || audioProcessor.getFilterSampleRate() != drawnSampleRate)
     {
-        //update the monochain
-        auto chainSettings = getChainSettings(audioProcessor.apvts);
-        auto peakCoefficients = makeChooseFilter(chainSettings, audioProcessor.getSampleRate());
-        updateCoefficients(monoChain.get<ChainPositions::Choose>().coefficients, peakCoefficients);
-
-        auto lowCutCoefficients = makeLowCutFilter(chainSettings, audioProcessor.getSampleRate());
-        auto highCutCoefficients = makeHighCutFilter(chainSettings, audioProcessor.getSampleRate());
-        updateCutFilter(monoChain.get<ChainPositions::LowCut>(), lowCutCoefficients, static_cast<Slope>(chainSettings.lowCutSlope));
-        updateCutFilter(monoChain.get<ChainPositions::HighCut>(), highCutCoefficients, static_cast<Slope>(chainSettings.highCutSlope));
+        updateResponseCurve();
         //signal a repaint
         repaint();
     }
-}
 
-void ResponseCurveComponent::paint(juce::Graphics& g)
-{
-    using namespace juce;
-    // (Our component is opaque, so we must completely fill the background with a solid colour)
-    g.fillAll(Colours::black);
+    auto preChanged = preEQAnalyser.process();
+    auto postChanged = postEQAnalyser.process();
 
-    auto responseArea = getLocalBounds();
+    if (preChanged || postChanged)
+    {
+        auto bounds = getLocalBounds().toFloat();
+        auto sampleRate = audioProcessor.getSampleRate();
 
-    auto w = responseArea.getWidth();
+        preEQAnalyser.createPath(preEQSpectrumPath, bounds, sampleRate, -96.f, 0.f);
+        postEQAnalyser.createPath(postEQSpectrumPath, bounds, sampleRate, -96.f, 0.f);
 
-    auto& lowcut = monoChain.get<ChainPositions::LowCut>();
-    auto& choose = monoChain.get<ChainPositions::Choose>();
-    auto& highcut = monoChain.get<ChainPositions::HighCut>();
+        repaint();
+    }
+}
 
-    auto sampleRate = audioProcessor.getSampleRate();
+void ResponseCurveComponent::resized()
+{
+    updateResponseCurve();
+}
 
-    std::vector<double> mags;
+void ResponseCurveComponent::updateResponseCurve()
+{
+    using namespace juce;
 
-    mags.resize(w);
+    auto responseArea = getLocalBounds();
 
-    for (int i = 0; i < w; i++)
-    {
-        double mag = 1.f;
-        auto freq = mapToLog10(double(i) / double(w), 20.0, 20000.0);
-
-        if (!monoChain.isBypassed<ChainPositions::Choose>())
-            mag *= choose.coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        if (!lowcut.isBypassed<0>())
-            mag *= lowcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<1>())
-            mag *= lowcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<2>())
-            mag *= lowcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!lowcut.isBypassed<3>())
-            mag *= lowcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        if (!highcut.isBypassed<0>())
-            mag *= highcut.get<0>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<1>())
-            mag *= highcut.get<1>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<2>())
-            mag *= highcut.get<2>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-        if (!highcut.isBypassed<3>())
-            mag *= highcut.get<3>().coefficients->getMagnitudeForFrequency(freq, sampleRate);
-
-        mags[i] = Decibels::gainToDecibels(mag);
-    }
+    // The filters' own rate, so the curve shows what oversampling does to
+    // bands near Nyquist.
+    auto sampleRate = drawnSampleRate = audioProcessor.getFilterSampleRate();
 
-    Path responseCurve;
+    if (sampleRate <= 0.0)
+        sampleRate = 44100.0; // Not prepared yet
 
     const double outputMin = responseArea.getBottom();
     const double outputMax = responseArea.getY();
@@ -110,35 +90,200 @@ void ResponseCurveComponent::paint(juce::Graphics& g)
         return jmap(input, -24.0, 24.0, outputMin, outputMax);
     };
 
-    responseCurve.startNewSubPath(responseArea.getX(), map(mags.front()));
+    auto numPaths = getStereoMode(audioProcessor.apvts) != StereoLinked ? numChainPaths : 1;
+    auto engine = getFilterEngine(audioProcessor.apvts);
 
-    for (size_t i = 1; i < mags.size(); i++)
+    for (int path = 0; path < numChainPaths; ++path)
     {
-        responseCurve.lineTo(responseArea.getX() + i, map(mags[i]));
+        auto& responseCurve = responseCurves[path];
+        auto& responseCurvePath = responseCurvePaths[path];
+
+        // clear() keeps the path's storage, so rebuilding doesn't allocate.
+        responseCurvePath.clear();
+
+        if (path >= numPaths)
+            continue;
+
+        responseCurve.setSize(responseArea.getWidth(), sampleRate);
+
+        ChainCoefficients coefficients;
+        calculateChainCoefficients(coefficients, getEngineChainSettings(getChainSettings(audioProcessor.apvts, path), engine),
+                                   sampleRate, AllStagesDirty);
+        responseCurve.update(coefficients);
+
+        const auto& mags = responseCurve.getMagnitudesInDecibels();
+
+        if (mags.empty())
+            continue;
+
+        responseCurvePath.startNewSubPath(responseArea.getX(), map(mags.front()));
+
+        for (size_t i = 1; i < mags.size(); i++)
+        {
+            responseCurvePath.lineTo(responseArea.getX() + i, map(mags[i]));
+        }
     }
+}
+
+void ResponseCurveComponent::paint(juce::Graphics& g)
+{
+    using namespace juce;
+    PerformanceCounters::ScopedTimer timer(audioProcessor.getPerformanceCounters(), PerformanceCounters::EditorPaint);
+
+    // (Our component is opaque, so we must completely fill the background with a solid colour)
+    g.fillAll(Colours::black);
+
+    auto responseArea = getLocalBounds();
+
+    g.setColour(Colours::grey.withAlpha(0.6f));
+    g.strokePath(preEQSpectrumPath, PathStrokeType(1.f));
+
+    g.setColour(Colours::skyblue.withAlpha(0.8f));
+    g.strokePath(postEQSpectrumPath, PathStrokeType(1.f));
 
     g.setColour(Colours::orange);
     g.drawRoundedRectangle(responseArea.toFloat(), 4.f, 1.f);
 
+    g.setColour(Colours::lightgreen);
+    g.strokePath(responseCurvePaths[PathB], PathStrokeType(2.f));
+
     g.setColour(Colours::white);
-    g.strokePath(responseCurve, PathStrokeType(2.f));
+    g.strokePath(responseCurvePaths[PathA], PathStrokeType(2.f));
 }
+//==============================================================================
+PerformanceDisplay::PerformanceDisplay(Project_EEAVAudioProcessor& p) : audioProcessor(p)
+{
+    showButton.onClick = [this]
+    {
+        if (showButton.getToggleState())
+        {
+            lastSnapshot = audioProcessor.getPerformanceCounters().getSnapshot();
+            statsLabel.setText("Measuring...", juce::dontSendNotification);
+            startTimerHz(2);
+        }
+        else
+        {
+            stopTimer();
+            statsLabel.setText({}, juce::dontSendNotification);
+        }
+    };
+
+    dumpButton.onClick = [this] { dumpToFile(); };
+
+    addAndMakeVisible(showButton);
+    addAndMakeVisible(dumpButton);
+    addAndMakeVisible(statsLabel);
+}
+
+void PerformanceDisplay::timerCallback()
+{
+    auto snapshot = audioProcessor.getPerformanceCounters().getSnapshot();
+
+    const auto& blocks = snapshot.sections[PerformanceCounters::ProcessBlock];
+    const auto& lastBlocks = lastSnapshot.sections[PerformanceCounters::ProcessBlock];
+    const auto& paints = snapshot.sections[PerformanceCounters::EditorPaint];
+    const auto& lastPaints = lastSnapshot.sections[PerformanceCounters::EditorPaint];
+
+    auto budget = snapshot.budgetTicks - lastSnapshot.budgetTicks;
+    auto load = budget > 0 ? static_cast<double>(blocks.totalTicks - lastBlocks.totalTicks) / static_cast<double>(budget) : 0.0;
+
+    auto numPaints = paints.calls - lastPaints.calls;
+    auto paintMilliseconds = numPaints > 0 ? PerformanceCounters::ticksToMilliseconds(paints.totalTicks - lastPaints.totalTicks) / static_cast<double>(numPaints) : 0.0;
+
+    statsLabel.setText("DSP " + juce::String(100.0 * load, 1) + "% (peak " + juce::String(100.0 * snapshot.getMaxBlockLoad(), 0) + "%)"
+                           + "  late blocks " + juce::String(static_cast<juce::int64>(snapshot.xrunRiskBlocks - lastSnapshot.xrunRiskBlocks))
+                           + "  redesigns " + juce::String(static_cast<juce::int64>(snapshot.coefficientRedesigns - lastSnapshot.coefficientRedesigns))
+                           + "  paint " + juce::String(paintMilliseconds, 2) + " ms",
+                       juce::dontSendNotification);
+
+    lastSnapshot = snapshot;
+}
+
+void PerformanceDisplay::dumpToFile()
+{
+    fileChooser = std::make_unique<juce::FileChooser>("Save performance counters",
+                                                      juce::File::getSpecialLocation(juce::File::userDocumentsDirectory)
+                                                          .getChildFile("EEAV performance.json"),
+                                                      "*.json");
+
+    auto flags = juce::FileBrowserComponent::saveMode
+               | juce::FileBrowserComponent::canSelectFiles
+               | juce::FileBrowserComponent::warnAboutOverwriting;
+
+    fileChooser->launchAsync(flags, [this](const juce::FileChooser& chooser)
+    {
+        auto file = chooser.getResult();
+
+        if (file != juce::File() && !audioProcessor.getPerformanceCounters().writeToFile(file))
+            statsLabel.setText("Couldn't write " + file.getFullPathName(), juce::dontSendNotification);
+    });
+}
+
+void PerformanceDisplay::resized()
+{
+    auto bounds = getLocalBounds();
+
+    showButton.setBounds(bounds.removeFromLeft(70));
+    dumpButton.setBounds(bounds.removeFromLeft(70));
+    statsLabel.setBounds(bounds);
+}
+
 //==============================================================================
 Project_EEAVAudioProcessorEditor::Project_EEAVAudioProcessorEditor (Project_EEAVAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p),
     responseCurveComponent(audioProcessor),
-	peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
-	peakGainSliderAttachment(audioProcessor.apvts, "Peak Gain", peakGainSlider),
-	peakQualitySliderAttachment(audioProcessor.apvts, "Peak Quality", peakQualitySlider),
-	lowCutFreqSliderAttachment(audioProcessor.apvts, "LowCut Freq", lowCutFreqSlider),
-	highCutFreqSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutFreqSlider),
-	lowCutSlopeSliderAttachment(audioProcessor.apvts, "LowCut Slope", lowCutSlopeSlider),
-	highCutSlopeSliderAttachment(audioProcessor.apvts, "HighCut Slope", highCutSlopeSlider),
-    chooseFilterComboAttachament(audioProcessor.apvts, "Choose filter", chooseFilterCombo)
+    performanceDisplay(audioProcessor),
+    smoothingButtonAttachment(audioProcessor.apvts, "Smoothing", smoothingButton),
+    morphTimeSliderAttachment(audioProcessor.apvts, "Morph Time", morphTimeSlider),
+    dynamicButtonAttachment(audioProcessor.apvts, "Dynamic", dynamicButton),
+    dynamicSidechainButtonAttachment(audioProcessor.apvts, "Dynamic Sidechain", dynamicSidechainButton),
+    dynamicThresholdSliderAttachment(audioProcessor.apvts, "Dynamic Threshold", dynamicThresholdSlider),
+    dynamicRatioSliderAttachment(audioProcessor.apvts, "Dynamic Ratio", dynamicRatioSlider),
+    dynamicAttackSliderAttachment(audioProcessor.apvts, "Dynamic Attack", dynamicAttackSlider),
+    dynamicReleaseSliderAttachment(audioProcessor.apvts, "Dynamic Release", dynamicReleaseSlider),
+    engineComboAttachment(audioProcessor.apvts, "Engine", engineCombo),
+    designComboAttachment(audioProcessor.apvts, "Design", designCombo),
+    oversamplingComboAttachment(audioProcessor.apvts, "Oversampling", oversamplingCombo),
+    stereoModeComboAttachment(audioProcessor.apvts, "Stereo Mode", stereoModeCombo)
 {
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
 
+    attachToPath(PathA);
+
+    pathButton.onClick = [this] { attachToPath(editedPath == PathA ? PathB : PathA); };
+
+    bandCombo.setSelectedItemIndex(editedBand, juce::dontSendNotification);
+    bandCombo.onChange = [this]
+    {
+        editedBand = juce::jmax(0, bandCombo.getSelectedItemIndex());
+        attachToPath(editedPath);
+    };
+    stereoModeCombo.onChange = [this]
+    {
+        if (getStereoMode(audioProcessor.apvts) == StereoLinked)
+            attachToPath(PathA);
+        else
+            updatePathButton();
+    };
+    engineCombo.onChange = [this] { updateDesignCombo(); };
+
+    snapshotCombo.setSelectedItemIndex(0, juce::dontSendNotification);
+    snapshotCombo.onChange = [this] { updateMorphButton(); };
+    storeButton.onClick = [this]
+    {
+        audioProcessor.storeSnapshot(juce::jmax(0, snapshotCombo.getSelectedItemIndex()));
+        updateMorphButton();
+    };
+    morphButton.onClick = [this] { audioProcessor.morphToSnapshot(juce::jmax(0, snapshotCombo.getSelectedItemIndex())); };
+    morphTimeSlider.setTextValueSuffix(" s");
+    dynamicThresholdSlider.setTextValueSuffix(" dB");
+    dynamicRatioSlider.setTextValueSuffix(":1");
+    dynamicAttackSlider.setTextValueSuffix(" ms attack");
+    dynamicReleaseSlider.setTextValueSuffix(" ms release");
+    updateMorphButton();
+    updateDesignCombo();
+
     for (auto* comp : getComps())
     {
 		addAndMakeVisible(comp);
@@ -153,6 +298,67 @@ Project_EEAVAudioProcessorEditor::~Project_EEAVAudioProcessorEditor()
 
 }
 
+void Project_EEAVAudioProcessorEditor::attachToPath(int path)
+{
+    auto& apvts = audioProcessor.apvts;
+    auto id = [path](const char* pathAParameterID) { return getParameterID(pathAParameterID, path); };
+    auto bandID = [path, band = editedBand](const char* band0ParameterID)
+    {
+        return getParameterID(getBandParameterID(band0ParameterID, band), path);
+    };
+
+    editedPath = path;
+
+    // Detach first: two attachments on one control would fight over it.
+    peakFreqSliderAttachment.reset();
+    peakGainSliderAttachment.reset();
+    peakQualitySliderAttachment.reset();
+    lowCutFreqSliderAttachment.reset();
+    highCutFreqSliderAttachment.reset();
+    lowCutSlopeSliderAttachment.reset();
+    highCutSlopeSliderAttachment.reset();
+    chooseFilterComboAttachament.reset();
+    bandOnButtonAttachment.reset();
+
+    peakFreqSliderAttachment = std::make_unique<Attachment>(apvts, bandID("Peak Freq"), peakFreqSlider);
+    peakGainSliderAttachment = std::make_unique<Attachment>(apvts, bandID("Peak Gain"), peakGainSlider);
+    peakQualitySliderAttachment = std::make_unique<Attachment>(apvts, bandID("Peak Quality"), peakQualitySlider);
+    lowCutFreqSliderAttachment = std::make_unique<Attachment>(apvts, id("LowCut Freq"), lowCutFreqSlider);
+    highCutFreqSliderAttachment = std::make_unique<Attachment>(apvts, id("HighCut Freq"), highCutFreqSlider);
+    lowCutSlopeSliderAttachment = std::make_unique<Attachment>(apvts, id("LowCut Slope"), lowCutSlopeSlider);
+    highCutSlopeSliderAttachment = std::make_unique<Attachment>(apvts, id("HighCut Slope"), highCutSlopeSlider);
+    chooseFilterComboAttachament = std::make_unique<ComboBoxAttachment>(apvts, bandID("Choose filter"), chooseFilterCombo);
+    bandOnButtonAttachment = std::make_unique<ButtonAttachment>(apvts, bandID("Peak On"), bandOnButton);
+
+    updatePathButton();
+}
+
+void Project_EEAVAudioProcessorEditor::updatePathButton()
+{
+    auto stereoMode = getStereoMode(audioProcessor.apvts);
+    auto isPathA = editedPath == PathA;
+
+    pathButton.setEnabled(stereoMode != StereoLinked);
+
+    if (stereoMode == MidSide)
+        pathButton.setButtonText(isPathA ? "Editing: Mid" : "Editing: Side");
+    else if (stereoMode == LeftRight)
+        pathButton.setButtonText(isPathA ? "Editing: Left" : "Editing: Right");
+    else
+        pathButton.setButtonText("Editing: Both");
+}
+
+void Project_EEAVAudioProcessorEditor::updateMorphButton()
+{
+    morphButton.setEnabled(audioProcessor.hasSnapshot(juce::jmax(0, snapshotCombo.getSelectedItemIndex())));
+}
+
+void Project_EEAVAudioProcessorEditor::updateDesignCombo()
+{
+    // The TPT engine has no choice of design.
+    designCombo.setEnabled(getFilterEngine(audioProcessor.apvts) != TPTEngine);
+}
+
 //==============================================================================
 void Project_EEAVAudioProcessorEditor::paint (juce::Graphics& g)
 {
@@ -182,7 +388,32 @@ void Project_EEAVAudioProcessorEditor::resized()
     highCutFreqSlider.setBounds(highCutArea.removeFromTop(highCutArea.getHeight() * 0.5));
 	highCutSlopeSlider.setBounds(highCutArea);
 
-	chooseFilterCombo.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.1));
+    auto bandArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    bandCombo.setBounds(bandArea.removeFromLeft(bandArea.getWidth() * 0.33));
+    bandOnButton.setBounds(bandArea.removeFromLeft(bandArea.getWidth() * 0.33));
+	chooseFilterCombo.setBounds(bandArea);
+    auto optionsArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    smoothingButton.setBounds(optionsArea.removeFromLeft(optionsArea.getWidth() * 0.25));
+    engineCombo.setBounds(optionsArea.removeFromLeft(optionsArea.getWidth() * 0.33));
+    designCombo.setBounds(optionsArea.removeFromLeft(optionsArea.getWidth() * 0.5));
+    oversamplingCombo.setBounds(optionsArea);
+    auto stereoArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    stereoModeCombo.setBounds(stereoArea.removeFromLeft(stereoArea.getWidth() * 0.5));
+    pathButton.setBounds(stereoArea);
+    auto snapshotArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    snapshotCombo.setBounds(snapshotArea.removeFromLeft(snapshotArea.getWidth() * 0.25));
+    storeButton.setBounds(snapshotArea.removeFromLeft(snapshotArea.getWidth() * 0.2));
+    morphButton.setBounds(snapshotArea.removeFromLeft(snapshotArea.getWidth() * 0.25));
+    morphTimeSlider.setBounds(snapshotArea);
+    auto dynamicArea = bounds.removeFromTop(bounds.getHeight() * 0.1);
+    auto dynamicWidth = dynamicArea.getWidth() / 6;
+    dynamicButton.setBounds(dynamicArea.removeFromLeft(dynamicWidth));
+    dynamicSidechainButton.setBounds(dynamicArea.removeFromLeft(dynamicWidth));
+    dynamicThresholdSlider.setBounds(dynamicArea.removeFromLeft(dynamicWidth));
+    dynamicRatioSlider.setBounds(dynamicArea.removeFromLeft(dynamicWidth));
+    dynamicAttackSlider.setBounds(dynamicArea.removeFromLeft(dynamicWidth));
+    dynamicReleaseSlider.setBounds(dynamicArea);
+    performanceDisplay.setBounds(bounds.removeFromBottom(24));
 	peakFreqSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.33));
     peakGainSlider.setBounds(bounds.removeFromTop(bounds.getHeight() * 0.5));
     peakQualitySlider.setBounds(bounds);
@@ -199,5 +430,24 @@ std::vector<juce::Component*> Project_EEAVAudioProcessorEditor::getComps()
         &lowCutSlopeSlider,
         &highCutSlopeSlider,
         &responseCurveComponent,
-        &chooseFilterCombo};
+        &chooseFilterCombo,
+        &smoothingButton,
+        &engineCombo,
+        &designCombo,
+        &oversamplingCombo,
+        &stereoModeCombo,
+        &pathButton,
+        &bandCombo,
+        &bandOnButton,
+        &snapshotCombo,
+        &storeButton,
+        &morphButton,
+        &morphTimeSlider,
+        &dynamicButton,
+        &dynamicSidechainButton,
+        &dynamicThresholdSlider,
+        &dynamicRatioSlider,
+        &dynamicAttackSlider,
+        &dynamicReleaseSlider,
+        &performanceDisplay};
 }
@@ -10,6 +10,8 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "ResponseCurve.h"
+#include "SpectrumAnalyser.h"
 
 struct CustomRotarySlider : juce::Slider 
 {
@@ -32,6 +34,64 @@ struct CustomComboBox : juce::ComboBox
     }
 };
 
+struct EngineComboBox : juce::ComboBox
+{
+    EngineComboBox()
+    {
+        addItem("Biquad", 1);
+        addItem("TPT", 2);
+        addItem("Linear Phase", 3);
+    }
+};
+
+struct DesignComboBox : juce::ComboBox
+{
+    DesignComboBox()
+    {
+        addItem("Bilinear", 1);
+        addItem("Matched", 2);
+    }
+};
+
+struct OversamplingComboBox : juce::ComboBox
+{
+    OversamplingComboBox()
+    {
+        addItem("Off", 1);
+        addItem("2x", 2);
+        addItem("4x", 3);
+        addItem("8x", 4);
+    }
+};
+
+struct StereoModeComboBox : juce::ComboBox
+{
+    StereoModeComboBox()
+    {
+        addItem("Stereo", 1);
+        addItem("Left/Right", 2);
+        addItem("Mid/Side", 3);
+    }
+};
+
+struct BandComboBox : juce::ComboBox
+{
+    BandComboBox()
+    {
+        for (int band = 0; band < maxBands; ++band)
+            addItem("Band " + juce::String(band + 1), band + 1);
+    }
+};
+
+struct SnapshotComboBox : juce::ComboBox
+{
+    SnapshotComboBox()
+    {
+        for (int slot = 0; slot < numSnapshots; ++slot)
+            addItem("Scene " + juce::String(slot + 1), slot + 1);
+    }
+};
+
 struct ResponseCurveComponent : juce::Component,
     juce::AudioProcessorParameter::Listener,
     juce::Timer
@@ -46,11 +106,47 @@ struct ResponseCurveComponent : juce::Component,
     void timerCallback() override;
 
     void paint(juce::Graphics& g) override;
+
+    void resized() override;
 private:
     Project_EEAVAudioProcessor& audioProcessor;
     juce::Atomic<bool> parametersChanged{ false };
 
-	MonoChain monoChain;
+    // Recomputes the responses and the cached paths; only called when the
+    // parameters, the size or the sample rate change, never from paint().
+    void updateResponseCurve();
+
+    // Path B's curve is only drawn while the "Stereo Mode" splits the paths.
+    std::array<ResponseCurve, numChainPaths> responseCurves;
+    std::array<juce::Path, numChainPaths> responseCurvePaths;
+    double drawnSampleRate{ 0.0 };
+
+    SpectrumAnalyser preEQAnalyser, postEQAnalyser;
+    juce::Path preEQSpectrumPath, postEQSpectrumPath;
+};
+
+// A one line summary of the processor's PerformanceCounters. Only polls them
+// while "Stats" is on; "Dump..." writes everything they hold as JSON.
+struct PerformanceDisplay : juce::Component,
+    juce::Timer
+{
+    PerformanceDisplay(Project_EEAVAudioProcessor&);
+
+    void timerCallback() override;
+
+    void resized() override;
+private:
+    Project_EEAVAudioProcessor& audioProcessor;
+
+    juce::ToggleButton showButton{ "Stats" };
+    juce::TextButton dumpButton{ "Dump..." };
+    juce::Label statsLabel;
+    std::unique_ptr<juce::FileChooser> fileChooser;
+
+    // The figures shown are for the time since this was taken.
+    PerformanceCounters::Snapshot lastSnapshot;
+
+    void dumpToFile();
 };
 
 //==============================================================================
@@ -85,11 +181,46 @@ private:
 
 	CustomComboBox chooseFilterCombo;
 
+    juce::ToggleButton smoothingButton{ "Smoothing" };
+
+    EngineComboBox engineCombo;
+
+    DesignComboBox designCombo;
+
+    OversamplingComboBox oversamplingCombo;
+
+    StereoModeComboBox stereoModeCombo;
+
+    // Switches the filter controls between path A and path B.
+    juce::TextButton pathButton;
+    int editedPath{ PathA };
+
+    // Picks which parametric band the peak controls edit.
+    BandComboBox bandCombo;
+    juce::ToggleButton bandOnButton{ "On" };
+    int editedBand{ 0 };
+
+    // Stores the current settings in the selected slot, or morphs to it.
+    SnapshotComboBox snapshotCombo;
+    juce::TextButton storeButton{ "Store" }, morphButton{ "Morph" };
+    juce::Slider morphTimeSlider{ juce::Slider::LinearHorizontal, juce::Slider::TextBoxRight };
+
+    // The dynamic band (band 0), and whether the sidechain bus keys it. The
+    // bars draw their value inside themselves.
+    juce::ToggleButton dynamicButton{ "Dynamic" }, dynamicSidechainButton{ "Sidechain" };
+    juce::Slider dynamicThresholdSlider{ juce::Slider::LinearBar, juce::Slider::TextBoxRight },
+        dynamicRatioSlider{ juce::Slider::LinearBar, juce::Slider::TextBoxRight },
+        dynamicAttackSlider{ juce::Slider::LinearBar, juce::Slider::TextBoxRight },
+        dynamicReleaseSlider{ juce::Slider::LinearBar, juce::Slider::TextBoxRight };
+
+    PerformanceDisplay performanceDisplay;
+
 	using APVTS = juce::AudioProcessorValueTreeState;
 	using Attachment = APVTS::SliderAttachment;
 	using ComboBoxAttachment = APVTS::ComboBoxAttachment;
 
-    Attachment peakFreqSliderAttachment,
+    // Recreated by attachToPath(), so they follow the edited path and band.
+    std::unique_ptr<Attachment> peakFreqSliderAttachment,
         peakGainSliderAttachment,
         peakQualitySliderAttachment,
         lowCutFreqSliderAttachment,
@@ -97,7 +228,29 @@ private:
         lowCutSlopeSliderAttachment,
         highCutSlopeSliderAttachment;
 
-	ComboBoxAttachment chooseFilterComboAttachament;
+	std::unique_ptr<ComboBoxAttachment> chooseFilterComboAttachament;
+
+    using ButtonAttachment = APVTS::ButtonAttachment;
+    std::unique_ptr<ButtonAttachment> bandOnButtonAttachment;
+    ButtonAttachment smoothingButtonAttachment;
+    Attachment morphTimeSliderAttachment;
+
+    ButtonAttachment dynamicButtonAttachment,
+        dynamicSidechainButtonAttachment;
+    Attachment dynamicThresholdSliderAttachment,
+        dynamicRatioSliderAttachment,
+        dynamicAttackSliderAttachment,
+        dynamicReleaseSliderAttachment;
+
+    ComboBoxAttachment engineComboAttachment,
+        designComboAttachment,
+        oversamplingComboAttachment,
+        stereoModeComboAttachment;
+
+    void attachToPath(int path);
+    void updatePathButton();
+    void updateMorphButton();
+    void updateDesignCombo();
 
     std::vector<juce::Component*> getComps();
 
@@ -16,16 +16,37 @@ Project_EEAVAudioProcessor::Project_EEAVAudioProcessor()
                      #if ! JucePlugin_IsMidiEffect
                       #if ! JucePlugin_IsSynth
                        .withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                       .withInput  ("Sidechain", juce::AudioChannelSet::stereo(), false)
                       #endif
                        .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
                      #endif
                        )
 #endif
 {
+    for (auto* param : getParameters())
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.addParameterListener(rangedParam->getParameterID(), this);
 }
 
 Project_EEAVAudioProcessor::~Project_EEAVAudioProcessor()
 {
+    cancelPendingUpdate();
+
+    for (auto* param : getParameters())
+        if (auto* rangedParam = dynamic_cast<juce::RangedAudioParameter*>(param))
+            apvts.removeParameterListener(rangedParam->getParameterID(), this);
+}
+
+template <>
+Project_EEAVAudioProcessor::FilterEngines<float>& Project_EEAVAudioProcessor::getEngines<float>() noexcept
+{
+    return floatEngines;
+}
+
+template <>
+Project_EEAVAudioProcessor::FilterEngines<double>& Project_EEAVAudioProcessor::getEngines<double>() noexcept
+{
+    return doubleEngines;
 }
 
 //==============================================================================
@@ -63,7 +84,37 @@ bool Project_EEAVAudioProcessor::isMidiEffect() const
 
 double Project_EEAVAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    auto sampleRate = getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return 0.0;
+
+    auto engine = static_cast<FilterEngine>(static_cast<int>(engineParameter->load()));
+    auto numPaths = static_cast<int>(stereoModeParameter->load()) != StereoLinked ? numChainPaths : 1;
+
+    return getRingDownSamples(engine, numPaths) / sampleRate;
+}
+
+int Project_EEAVAudioProcessor::getRingDownSamples(FilterEngine engine, int numPaths) const noexcept
+{
+    if (engine == LinearPhaseEngine)
+        return linearPhaseDesigner.getKernelSize() + linearPhaseConvolution.getLatency();
+
+    auto sampleRate = getSampleRate();
+    auto rate = getFilterSampleRate();
+    auto ringDown = 0;
+
+    for (int path = 0; path < numPaths; ++path)
+    {
+        ChainCoefficients coefficients;
+        calculateChainCoefficients(coefficients, getEngineChainSettings(chainParameters[path].load(), engine), rate, AllStagesDirty);
+        ringDown = juce::jmax(ringDown, getChainRingDownSamples(coefficients, rate, ringDownAttenuationInDecibels));
+    }
+
+    // The oversampler's own filters ring for about as long again as they delay.
+    auto hostRateRingDown = static_cast<double>(ringDown) * sampleRate / rate + 2.0 * getOversamplingLatency();
+
+    return static_cast<int>(std::ceil(hostRateRingDown));
 }
 
 int Project_EEAVAudioProcessor::getNumPrograms()
@@ -100,21 +151,104 @@ void Project_EEAVAudioProcessor::prepareToPlay (double sampleRate, int samplesPe
 
 	spec.maximumBlockSize = samplesPerBlock;
 
-    spec.numChannels = 1;
+    spec.numChannels = static_cast<juce::uint32>(juce::jlimit(1, maxChannels, getTotalNumOutputChannels()));
 
 	spec.sampleRate = sampleRate;
 
-	leftChain.prepare(spec);
-	rightChain.prepare(spec);
+    // Stop the designer first: preparing may change how many convolutions
+    // it loads kernels into.
+    linearPhaseDesigner.release();
+    linearPhaseConvolution.prepare(spec);
+
+    // The IIR engines run inside the oversampler, at the raised rate.
+    auto factorLog2 = static_cast<size_t>(apvts.getRawParameterValue("Oversampling")->load());
+
+    auto factor = 1 << factorLog2;
+    filterSampleRate.store(sampleRate * factor);
+
+    auto filterSpec = spec;
+    filterSpec.sampleRate = sampleRate * factor;
+    filterSpec.maximumBlockSize = spec.maximumBlockSize * static_cast<juce::uint32>(factor);
+
+    // Hosts choose the precision before preparing, so only that set of
+    // engines needs its buffers.
+    if (isUsingDoublePrecision())
+    {
+        doubleEngines.prepare(spec, factorLog2);
+        floatEngines.oversampling.reset();
+        linearPhaseBuffer.setSize(static_cast<int>(spec.numChannels), samplesPerBlock);
+    }
+    else
+    {
+        floatEngines.prepare(spec, factorLog2);
+        doubleEngines.oversampling.reset();
+        linearPhaseBuffer.setSize(0, 0);
+    }
+
+    for (auto& smoother : smoothers)
+        smoother.reset(filterSpec.sampleRate, smoothingRampSeconds);
+
+    smoothingWasActive = false;
+    svfSettingsValid = false;
+    activeMorph = nullptr;
+    morphEngine.setProgress(1.f);
+    for (auto& band : dynamicBands)
+        band.prepare(sampleRate, samplesPerBlock);
+
+    dynamicsActive = false;
+    dynamicGainsInDecibels.fill(0.f);
+    dynamicStages = 0;
+    eventStages = 0;
+    activeEngine = static_cast<FilterEngine>(static_cast<int>(engineParameter->load()));
+    silenceDetector.reset();
+
+    activeStereoMode = static_cast<StereoMode>(static_cast<int>(stereoModeParameter->load()));
+    floatEngines.filterChain.setStereoMode(activeStereoMode);
+    floatEngines.svfChain.setStereoMode(activeStereoMode);
+    doubleEngines.filterChain.setStereoMode(activeStereoMode);
+    doubleEngines.svfChain.setStereoMode(activeStereoMode);
+    linearPhaseConvolution.setStereoMode(activeStereoMode);
+
+    coefficientDesigner.prepare(filterSpec.sampleRate);
+
+    if (auto* coefficients = coefficientDesigner.acquireLatest())
+        applyCoefficients(*coefficients);
+
+    linearPhaseDesigner.prepare(sampleRate, filterSpec.sampleRate);
+    updateLatency();
+}
+
+template <typename SampleType>
+void Project_EEAVAudioProcessor::FilterEngines<SampleType>::prepare(const juce::dsp::ProcessSpec& hostSpec, size_t oversamplingFactorLog2)
+{
+    oversampling.reset();
+
+    if (oversamplingFactorLog2 > 0)
+    {
+        oversampling = std::make_unique<juce::dsp::Oversampling<SampleType>>(hostSpec.numChannels,
+                                                                              oversamplingFactorLog2,
+                                                                              juce::dsp::Oversampling<SampleType>::filterHalfBandPolyphaseIIR,
+                                                                              true,
+                                                                              true);
+        oversampling->initProcessing(static_cast<size_t>(hostSpec.maximumBlockSize));
+    }
+
+    auto factor = 1 << oversamplingFactorLog2;
 
-	updateFilters();
+    auto filterSpec = hostSpec;
+    filterSpec.sampleRate = hostSpec.sampleRate * factor;
+    filterSpec.maximumBlockSize = hostSpec.maximumBlockSize * static_cast<juce::uint32>(factor);
 
+    filterChain.prepare(filterSpec);
+    svfChain.prepare(filterSpec);
 }
 
 void Project_EEAVAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+    coefficientDesigner.release();
+    linearPhaseDesigner.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -124,18 +258,23 @@ bool Project_EEAVAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout from mono up to maxChannels (7.1.4). Only the first two
+    // channels can be split by the "Stereo Mode"; the rest always run path A,
+    // so the channel roles don't matter.
+    auto numChannels = layouts.getMainOutputChannelSet().size();
+
+    if (layouts.getMainOutputChannelSet().isDisabled() || numChannels > maxChannels)
         return false;
 
     // This checks if the input layout matches the output layout
    #if ! JucePlugin_IsSynth
     if (layouts.getMainOutputChannelSet() != layouts.getMainInputChannelSet())
         return false;
+
+    // The sidechain only keys the dynamic band, which sums it to mono, so
+    // any width will do.
+    if (layouts.getChannelSet(true, 1).size() > maxChannels)
+        return false;
    #endif
 
     return true;
@@ -144,6 +283,19 @@ bool Project_EEAVAudioProcessor::isBusesLayoutSupported (const BusesLayout& layo
 #endif
 
 void Project_EEAVAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    PerformanceCounters::ScopedBlockTimer timer(performanceCounters, buffer.getNumSamples(), getSampleRate());
+    processSamples(buffer);
+}
+
+void Project_EEAVAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    PerformanceCounters::ScopedBlockTimer timer(performanceCounters, buffer.getNumSamples(), getSampleRate());
+    processSamples(buffer);
+}
+
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processSamples(juce::AudioBuffer<SampleType>& buffer) noexcept
 {
     juce::ScopedNoDenormals noDenormals;
     auto totalNumInputChannels  = getTotalNumInputChannels();
@@ -158,241 +310,945 @@ void Project_EEAVAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    updateFilters();
+    // The sidechain bus only keys the dynamic band; everything else runs on
+    // the main bus.
+    auto mainBuffer = getBusBuffer(buffer, false, 0);
+	juce::dsp::AudioBlock<SampleType> block(mainBuffer);
+
+    auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(maxChannels));
+    auto channels = block.getSubsetChannelBlock(0, numChannels);
+
+    // Pushing is a mixdown and a copy, with no FFT on this thread.
+    auto analyserActive = analyserConsumers.load(std::memory_order_relaxed) > 0;
+
+    if (analyserActive)
+        preEQFifo.push(channels);
+
+    // Whatever was scheduled was for this block, even if it isn't filtered.
+    numBlockEvents = parameterEvents.pop(blockEvents.data(), static_cast<int>(blockEvents.size()));
+
+    // A new morph replaces the current one, which it starts from. One staged
+    // for another filter rate came before the last prepareToPlay().
+    if (auto* morph = morphEngine.acquireMorph())
+    {
+        activeMorph = morph;
+        morphPosition = 0.0;
+
+        if (morph->sampleRate != getFilterSampleRate())
+            finishMorph();
+    }
+
+    auto engine = static_cast<FilterEngine>(static_cast<int>(engineParameter->load()));
 
-	juce::dsp::AudioBlock<float> block(buffer);
+    if (engine != activeEngine)
+        switchEngine(engine);
 
-	auto leftBlock = block.getSingleChannelBlock(0);
-	auto rightBlock = block.getSingleChannelBlock(1);
+    // The linear phase kernel can't follow a moving response, so that
+    // engine goes straight to the parameters the morph ends on.
+    if (activeMorph != nullptr && engine == LinearPhaseEngine)
+        finishMorph();
 
-	juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-    juce::dsp::ProcessContextReplacing<float> rigthContext(rightBlock);
+    auto stereoMode = static_cast<StereoMode>(static_cast<int>(stereoModeParameter->load()));
 
-	leftChain.process(leftContext);
-	rightChain.process(rigthContext);
+    if (stereoMode != activeStereoMode)
+        switchStereoMode(stereoMode);
 
+    // Silent tracks stop costing anything once their filters have rung down.
+    auto inputIsSilent = SilenceDetector::isSilent(channels);
 
+    if (silenceDetector.isSilenceStarting(inputIsSilent))
+        silenceDetector.setRingDownSamples(getRingDownSamples(engine, getNumActivePaths()));
 
+    auto blockAction = silenceDetector.advance(inputIsSilent, static_cast<int>(channels.getNumSamples()));
+
+    // The linear phase kernel can't follow a gain that moves every few
+    // samples, so only the IIR engines run the dynamic band.
+    dynamicsActive = false;
+
+    if (blockAction != SilenceDetector::Process)
+    {
+        if (blockAction == SilenceDetector::Flush)
+            flushFilters();
+
+        // Nobody hears the rest of it.
+        if (activeMorph != nullptr)
+            finishMorph();
+
+        channels.clear();
+    }
+    else if (engine == LinearPhaseEngine)
+    {
+        processLinearPhase(channels);
+    }
+    else
+    {
+        dynamicsActive = dynamicParameter->load() >= 0.5f;
+
+        if (dynamicsActive)
+            detectDynamics(buffer, channels);
+
+        auto& oversampling = getEngines<SampleType>().oversampling;
+        auto filterBlock = oversampling != nullptr ? oversampling->processSamplesUp(channels) : channels;
+
+        processFilterEngine(filterBlock, engine, oversampling != nullptr ? oversampling->getOversamplingFactor() : 1);
+
+        if (oversampling != nullptr)
+            oversampling->processSamplesDown(channels);
+    }
+
+    if (analyserActive)
+        postEQFifo.push(channels);
 }
 
-//==============================================================================
-bool Project_EEAVAudioProcessor::hasEditor() const
+void Project_EEAVAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<float>& block) noexcept
 {
-    return true; // (change this to false if you choose to not supply an editor)
+    juce::dsp::ProcessContextReplacing<float> context(block);
+    linearPhaseConvolution.process(context);
 }
 
-juce::AudioProcessorEditor* Project_EEAVAudioProcessor::createEditor()
+void Project_EEAVAudioProcessor::processLinearPhase(juce::dsp::AudioBlock<double>& block) noexcept
 {
-    return new Project_EEAVAudioProcessorEditor (*this);
-    //return new juce::GenericAudioProcessorEditor(*this);
+    // The kernel is float anyway, so converting costs no accuracy that the
+    // convolution would have kept.
+    auto numChannels = block.getNumChannels();
+    auto numSamples = block.getNumSamples();
+
+    jassert(numChannels <= static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+    jassert(numSamples <= static_cast<size_t>(linearPhaseBuffer.getNumSamples()));
+
+    auto floatBlock = juce::dsp::AudioBlock<float>(linearPhaseBuffer).getSubBlock(0, numSamples)
+                                                                      .getSubsetChannelBlock(0, numChannels);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = block.getChannelPointer(channel);
+        auto* destination = floatBlock.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<float>(source[i]);
+    }
+
+    processLinearPhase(floatBlock);
+
+    for (size_t channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* source = floatBlock.getChannelPointer(channel);
+        auto* destination = block.getChannelPointer(channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = static_cast<double>(source[i]);
+    }
 }
 
-//==============================================================================
-void Project_EEAVAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+void Project_EEAVAudioProcessor::switchEngine(FilterEngine newEngine) noexcept
+{
+    // The engine being switched to has stale state and, for the biquads,
+    // possibly stale coefficients, as it hasn't run for a while.
+    smoothingWasActive = false;
+    svfSettingsValid = false;
+
+    if (newEngine == BiquadEngine)
+    {
+        recalculateCoefficients();
+        floatEngines.filterChain.reset();
+        doubleEngines.filterChain.reset();
+    }
+    else if (newEngine == TPTEngine)
+    {
+        floatEngines.svfChain.reset();
+        doubleEngines.svfChain.reset();
+    }
+    else
+    {
+        linearPhaseConvolution.reset();
+    }
+
+    activeEngine = newEngine;
+}
+
+void Project_EEAVAudioProcessor::finishMorph() noexcept
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    activeMorph = nullptr;
+    morphEngine.setProgress(1.f);
 
-    juce::MemoryOutputStream mos (destData, true);
-	apvts.state.writeToStream(mos);
+    // Whatever the designer published during the morph may be from before
+    // the parameters were set to the target; what it publishes from now on
+    // is not.
+    coefficientDesigner.acquireLatest();
+
+    if (activeEngine == BiquadEngine)
+        recalculateCoefficients();
+
+    smoothingWasActive = false;
+    eventCoefficientsActive = false;
 }
 
-void Project_EEAVAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+void Project_EEAVAudioProcessor::flushFilters() noexcept
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
-	auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
-    if (tree.isValid())
+    // Same as switching to the active engine: its state is cleared, and
+    // smoothing restarts from the targets rather than ramping from settings
+    // that went stale while blocks were skipped.
+    switchEngine(activeEngine);
+
+    if (floatEngines.oversampling != nullptr)
+        floatEngines.oversampling->reset();
+
+    if (doubleEngines.oversampling != nullptr)
+        doubleEngines.oversampling->reset();
+
+    for (auto& band : dynamicBands)
+        band.reset();
+}
+
+void Project_EEAVAudioProcessor::switchStereoMode(StereoMode newStereoMode) noexcept
+{
+    // The lanes now carry different signals, so old filter state would only
+    // be a transient. Path B may have been left behind while it was unused.
+    activeStereoMode = newStereoMode;
+
+    floatEngines.filterChain.setStereoMode(newStereoMode);
+    floatEngines.svfChain.setStereoMode(newStereoMode);
+    doubleEngines.filterChain.setStereoMode(newStereoMode);
+    doubleEngines.svfChain.setStereoMode(newStereoMode);
+    linearPhaseConvolution.setStereoMode(newStereoMode);
+
+    smoothingWasActive = false;
+    svfSettingsValid = false;
+
+    // Path B's detector keyed a band that was not in use, or not at all.
+    dynamicBands[PathB].reset();
+    dynamicGainsInDecibels[PathB] = 0.f;
+
+    if (activeEngine == BiquadEngine)
+        recalculateCoefficients();
+
+    floatEngines.filterChain.reset();
+    floatEngines.svfChain.reset();
+    doubleEngines.filterChain.reset();
+    doubleEngines.svfChain.reset();
+}
+
+void Project_EEAVAudioProcessor::recalculateCoefficients() noexcept
+{
+    PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+
+    for (int path = 0; path < numChainPaths; ++path)
+        calculateChainCoefficients(smoothedCoefficients[path], chainParameters[path].load(), getFilterSampleRate(), AllStagesDirty);
+
+    eventStages = 0;
+    applyCoefficients(smoothedCoefficients);
+}
+
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processFilterEngine(juce::dsp::AudioBlock<SampleType>& block,
+                                                     FilterEngine engine,
+                                                     size_t oversamplingFactor) noexcept
+{
+    // A morph owns the filters until it ends, so it also overrides this
+    // block's events.
+    if (activeMorph != nullptr)
     {
-		apvts.replaceState(tree);
-		updateFilters();
+        processMorph(block, engine);
+        return;
+    }
+
+    auto numPaths = getNumActivePaths();
+
+    for (int path = 0; path < numPaths; ++path)
+        targetSettings[path] = chainParameters[path].load();
+
+    // The designer only knows the parameters, so events' biquad coefficients
+    // are calculated here with the allocation free designs. The next block
+    // starts again from the parameters, whether or not the caller set them
+    // to the events' final values, and hands back to the designer once a
+    // block has no events.
+    auto usesDesignedCoefficients = engine == BiquadEngine && smoothingParameter->load() < 0.5f;
+
+    if (!usesDesignedCoefficients)
+    {
+        eventCoefficientsActive = false;
+    }
+    else if (dynamicsActive)
+    {
+        // The dynamic band keeps the designer's snapshots as its base, so
+        // only band 0, plus whatever events change, is calculated here.
+        if (isNonRealtime())
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+            coefficientDesigner.designPendingStages();
+        }
+
+        if (auto* coefficients = coefficientDesigner.acquireLatest())
+        {
+            // Holds the stages the designer changed, and puts back those
+            // the last block's events replaced; band 0 lacks the gain change.
+            smoothedCoefficients = *coefficients;
+            dynamicStages = getBandDirtyBit(0);
+            eventStages = 0;
+            eventCoefficientsActive = true;
+        }
+        else if (eventCoefficientsActive)
+        {
+            dynamicStages = eventStages;
+            eventStages = 0;
+        }
+        else
+        {
+            // Only when the band turns dynamic without a new snapshot:
+            // smoothedCoefficients may not be what the biquads are running.
+            dynamicStages = AllStagesDirty;
+        }
+    }
+    else if (eventCoefficientsActive)
+    {
+        // Anything designed before now may be from the parameters the
+        // events replaced.
+        coefficientDesigner.acquireLatest();
+        recalculateCoefficients();
+        eventCoefficientsActive = numBlockEvents > 0;
+    }
+
+    // The engines that were just reset have coefficients without the
+    // dynamic band's gain change.
+    if (!dynamicsActive)
+    {
+        for (auto& gain : dynamicGainsInDecibels)
+        {
+            if (gain != 0.f)
+                dynamicStages = getBandDirtyBit(0);
+
+            gain = 0.f;
+        }
+    }
+    else if (!usesDesignedCoefficients && !smoothingWasActive)
+        dynamicStages = getBandDirtyBit(0);
+
+    auto numSamples = block.getNumSamples();
+    auto lastOffset = numSamples - juce::jmin(numSamples, oversamplingFactor);
+    auto minimumSpacing = static_cast<size_t>(minimumEventSpacing.load()) * oversamplingFactor;
+    auto sampleRate = getFilterSampleRate();
+    auto dynamicSubBlock = static_cast<size_t>(dynamicUpdateInterval) * oversamplingFactor;
+    int eventIndex = 0;
+
+    for (size_t start = 0; start < numSamples;)
+    {
+        // Apply the events due by `start`, including any too close after it
+        // to be worth a sub-block of their own, and stop at the next one.
+        std::array<int, numChainPaths> changedStages{};
+        auto end = numSamples;
+
+        for (; eventIndex < numBlockEvents; ++eventIndex)
+        {
+            const auto& event = blockEvents[static_cast<size_t>(eventIndex)];
+            auto offset = juce::jmin(static_cast<size_t>(event.sampleOffset) * oversamplingFactor, lastOffset);
+
+            if (offset >= start + minimumSpacing)
+            {
+                end = offset;
+                break;
+            }
+
+            if (event.path < numPaths)
+                changedStages[event.path] |= chainParameters[event.path].apply(targetSettings[event.path], event.parameter, event.value);
+        }
+
+        eventStages |= changedStages[PathA] | changedStages[PathB];
+
+        // The dynamic band's gain changes at most once per detector interval.
+        if (dynamicsActive)
+        {
+            end = juce::jmin(end, (start / dynamicSubBlock + 1) * dynamicSubBlock);
+            updateDynamicGain(static_cast<int>(start / oversamplingFactor));
+
+            if (usesDesignedCoefficients)
+                for (auto& stages : changedStages)
+                    stages |= dynamicStages;
+        }
+
+        if (usesDesignedCoefficients && (changedStages[PathA] | changedStages[PathB]) != 0)
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+
+            // The first time, the other stages may still hold the designer's
+            // older coefficients.
+            for (int path = 0; path < numPaths; ++path)
+                calculateChainCoefficients(smoothedCoefficients[path],
+                                           applyDynamics(targetSettings[path], path),
+                                           sampleRate,
+                                           eventCoefficientsActive ? changedStages[path] : AllStagesDirty);
+
+            applyCoefficients(smoothedCoefficients);
+            eventCoefficientsActive = true;
+        }
+
+        auto subBlock = block.getSubBlock(start, end - start);
+
+        if (engine == TPTEngine)
+            processWithStateVariableFilters(subBlock);
+        else if (!usesDesignedCoefficients)
+            processSmoothed(subBlock);
+        else
+            processWithDesignedCoefficients(subBlock);
+
+        dynamicStages = 0;
+        start = end;
     }
 }
 
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts) 
+template <typename SampleType>
+void Project_EEAVAudioProcessor::detectDynamics(juce::AudioBuffer<SampleType>& buffer,
+                                                const juce::dsp::AudioBlock<SampleType>& input) noexcept
 {
+    std::array<const SampleType*, maxChannels> key{};
+    auto numKeyChannels = 0;
+
+    // The external key only counts while the host feeds the sidechain bus.
+    if (dynamicSidechainParameter->load() >= 0.5f && getBusCount(true) > 1 && getChannelCountOfBus(true, 1) > 0)
+    {
+        auto sidechain = getBusBuffer(buffer, true, 1);
+        numKeyChannels = juce::jmin(sidechain.getNumChannels(), maxChannels);
+
+        for (int channel = 0; channel < numKeyChannels; ++channel)
+            key[static_cast<size_t>(channel)] = sidechain.getReadPointer(channel);
+    }
+    else
+    {
+        numKeyChannels = static_cast<int>(input.getNumChannels());
+
+        for (int channel = 0; channel < numKeyChannels; ++channel)
+            key[static_cast<size_t>(channel)] = input.getChannelPointer(static_cast<size_t>(channel));
+    }
 
-	ChainSettings settings;
+    DynamicSettings settings;
+    settings.thresholdInDecibels = dynamicThresholdParameter->load();
+    settings.ratio = dynamicRatioParameter->load();
+    settings.attackMilliseconds = dynamicAttackParameter->load();
+    settings.releaseMilliseconds = dynamicReleaseParameter->load();
 
-    settings.lowCutFreq = apvts.getRawParameterValue("LowCut Freq")->load();
-    settings.highCutFreq = apvts.getRawParameterValue("HighCut Freq")->load();
-	settings.filterName = static_cast<FilterType> (apvts.getRawParameterValue("Choose filter")->load());
-    settings.peakFreq = apvts.getRawParameterValue("Peak Freq")->load();
-    settings.peakGainInDecibels = apvts.getRawParameterValue("Peak Gain")->load();
-    settings.peakQuality = apvts.getRawParameterValue("Peak Quality")->load();
-    settings.lowCutSlope = static_cast<Slope>(apvts.getRawParameterValue("LowCut Slope")->load());
-    settings.highCutSlope = static_cast<Slope>(apvts.getRawParameterValue("HighCut Slope")->load());
+    dynamicUpdateInterval = smoothingUpdateInterval.load();
 
-	return settings;
+    // Each path's band 0 is keyed at its own frequency and Q, so a split
+    // path B is only moved by what it acts on.
+    for (int path = 0; path < getNumActivePaths(); ++path)
+    {
+        const auto band = chainParameters[path].load();
+
+        dynamicBands[path].process(key.data(), numKeyChannels, static_cast<int>(input.getNumSamples()),
+                                   band.peakFreq[0], band.peakQuality[0], settings, dynamicUpdateInterval);
+    }
 }
 
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate)
+void Project_EEAVAudioProcessor::updateDynamicGain(int hostSample) noexcept
 {
-	return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate,
-		chainSettings.peakFreq,
-		chainSettings.peakQuality,
-		juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
+    for (int path = 0; path < getNumActivePaths(); ++path)
+    {
+        auto gain = dynamicBands[path].getGainInDecibels(hostSample / dynamicUpdateInterval);
+        auto& current = dynamicGainsInDecibels[path];
+
+        if (std::abs(gain - current) >= dynamicGainStepInDecibels)
+        {
+            current = gain;
+            dynamicStages |= getBandDirtyBit(0);
+        }
+    }
 }
 
-Coefficients makeNotchFilter(const ChainSettings& chainSettings, double sampleRate)
+ChainSettings Project_EEAVAudioProcessor::applyDynamics(ChainSettings settings, int path) const noexcept
 {
-    return juce::dsp::IIR::Coefficients<float>::makeNotch(sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality);
+    auto gain = dynamicGainsInDecibels[path];
+
+    // Kept within the "Peak Gain" range.
+    if (gain != 0.f)
+        settings.peakGainInDecibels[0] = juce::jlimit(-24.f, 24.f, settings.peakGainInDecibels[0] + gain);
+
+    return settings;
 }
 
-Coefficients makeBandPassFilter(const ChainSettings& chainSettings, double sampleRate)
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processWithDesignedCoefficients(juce::dsp::AudioBlock<SampleType>& block) noexcept
 {
-    return juce::dsp::IIR::Coefficients<float>::makeBandPass(sampleRate,
-        chainSettings.peakFreq,
-        chainSettings.peakQuality);
+    smoothingWasActive = false;
+
+    // Offline renders design on this thread so parameter changes land on
+    // deterministic blocks; in realtime the design worker does the work.
+    // Neither may replace coefficients calculated for this block's events.
+    if (!eventCoefficientsActive)
+    {
+        if (isNonRealtime())
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+            coefficientDesigner.designPendingStages();
+        }
+
+        if (auto* coefficients = coefficientDesigner.acquireLatest())
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+            applyCoefficients(*coefficients);
+        }
+    }
+
+	juce::dsp::ProcessContextReplacing<SampleType> context(block);
+
+	getEngines<SampleType>().filterChain.process(context);
 }
 
-Coefficients makeChooseFilter(const ChainSettings& chainSettings, double sampleRate)
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processSmoothed(juce::dsp::AudioBlock<SampleType>& block) noexcept
 {
-    switch (chainSettings.filterName)
+    auto& filterChain = getEngines<SampleType>().filterChain;
+
+    // Designer snapshots are left unread here: the newest one is applied as
+    // soon as smoothing is switched off again.
+    auto numPaths = getNumActivePaths();
+    auto isSmoothing = false;
+
+    for (int path = 0; path < numPaths; ++path)
+    {
+        const auto& target = targetSettings[path];
+
+        if (smoothingWasActive)
+            smoothers[path].setTarget(target);
+        else
+            smoothers[path].setCurrentAndTarget(target);
+
+        isSmoothing = isSmoothing || smoothers[path].isSmoothing();
+    }
+
+    smoothingWasActive = true;
+
+    auto sampleRate = getFilterSampleRate();
+    auto numSamples = block.getNumSamples();
+    auto pendingDynamicStages = dynamicStages;
+
+    if (!isSmoothing && pendingDynamicStages == 0)
     {
-    case PeakFilter:
-        return makePeakFilter(chainSettings, sampleRate);
-    case NotchFilter:
-        return makeNotchFilter(chainSettings, sampleRate);
-    case BandPassFilter:
-        return makeBandPassFilter(chainSettings, sampleRate);
-    default:
-        jassertfalse; // Invalid filter type
-        return {};
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+        filterChain.process(context);
+        return;
+    }
+
+    // Coefficients are recalculated on a fixed sub-block grid with the
+    // allocation free designs, so the cost per block stays bounded.
+    auto interval = static_cast<size_t>(smoothingUpdateInterval.load());
+
+    for (size_t start = 0; start < numSamples; start += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - start);
+        std::array<int, numChainPaths> stages{};
+
+        for (int path = 0; path < numPaths; ++path)
+            stages[path] = smoothers[path].advance(static_cast<int>(length)) | pendingDynamicStages;
+
+        pendingDynamicStages = 0;
+
+        if ((stages[PathA] | stages[PathB]) != 0)
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+
+            for (int path = 0; path < numPaths; ++path)
+                if (stages[path] != 0)
+                    calculateChainCoefficients(smoothedCoefficients[path], applyDynamics(smoothers[path].getCurrent(), path), sampleRate, stages[path]);
+
+            applyCoefficients(smoothedCoefficients);
+        }
+
+        auto subBlock = block.getSubBlock(start, length);
+        juce::dsp::ProcessContextReplacing<SampleType> context(subBlock);
+        filterChain.process(context);
     }
 }
 
-void Project_EEAVAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processMorph(juce::dsp::AudioBlock<SampleType>& block, FilterEngine engine) noexcept
 {
-	auto peakCoefficients = makePeakFilter(chainSettings, getSampleRate());
+    auto& filterChain = getEngines<SampleType>().filterChain;
+    auto& svfChain = getEngines<SampleType>().svfChain;
+    const auto& morph = *activeMorph;
+
+    // The keyframes were designed by the morph engine; here they are only
+    // interpolated, on the same sub-block grid as smoothing uses.
+    auto lastKeyframe = static_cast<double>(morph.numKeyframes - 1);
+    auto interval = static_cast<size_t>(smoothingUpdateInterval.load());
+    auto numSamples = block.getNumSamples();
+    auto numPaths = getNumActivePaths();
+
+    for (size_t start = 0; start < numSamples; start += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - start);
+
+        if (engine == TPTEngine)
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+
+            // The chain ramps per sample to where the morph is at the end of
+            // the sub-block, which costs a tan per stage.
+            morphPosition += static_cast<double>(length) / morph.samplesPerKeyframe;
+
+            auto position = juce::jmin(morphPosition, lastKeyframe);
+            auto keyframe = juce::jmin(static_cast<int>(position), morph.numKeyframes - 2);
+            const auto& from = morph.settings[static_cast<size_t>(keyframe)];
+            const auto& to = morph.settings[static_cast<size_t>(keyframe + 1)];
+
+            for (int path = 0; path < numPaths; ++path)
+            {
+                auto settings = interpolateChainSettings(from[path], to[path], static_cast<float>(position - keyframe));
+                svfChain.setParameters(settings, svfSettingsValid ? static_cast<int>(length) : 0, path);
+                svfSettings[path] = settings;
+            }
+
+            svfSettingsValid = true;
+            performanceCounters.countCoefficientRedesign();
+        }
+        else
+        {
+            PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+
+            auto position = juce::jmin(morphPosition, lastKeyframe);
+            auto keyframe = juce::jmin(static_cast<int>(position), morph.numKeyframes - 2);
+            const auto& from = morph.keyframes[static_cast<size_t>(keyframe)];
+            const auto& to = morph.keyframes[static_cast<size_t>(keyframe + 1)];
+
+            for (int path = 0; path < numPaths; ++path)
+                interpolateChainCoefficients(smoothedCoefficients[path], from[path], to[path], position - keyframe);
+
+            applyCoefficients(smoothedCoefficients);
+            morphPosition += static_cast<double>(length) / morph.samplesPerKeyframe;
+        }
+
+        auto subBlock = block.getSubBlock(start, length);
+        juce::dsp::ProcessContextReplacing<SampleType> context(subBlock);
+
+        if (engine == TPTEngine)
+            svfChain.process(context);
+        else
+            filterChain.process(context);
+    }
 
-	updateCoefficients(leftChain.get<ChainPositions::Choose>().coefficients, peakCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Choose>().coefficients, peakCoefficients);
+    if (morphPosition >= lastKeyframe)
+        finishMorph();
+    else
+        morphEngine.setProgress(static_cast<float>(morphPosition / lastKeyframe));
 }
 
-void Project_EEAVAudioProcessor::updateNotchFilter(const ChainSettings& chainSettings)
+template <typename SampleType>
+void Project_EEAVAudioProcessor::processWithStateVariableFilters(juce::dsp::AudioBlock<SampleType>& block) noexcept
 {
-    auto nocthCoefficients = makeNotchFilter(chainSettings, getSampleRate());
+    auto& svfChain = getEngines<SampleType>().svfChain;
+
+    // The SVF engine needs no designer: new parameters cost a tan per stage,
+    // so they are worked out here on the audio thread.
+    auto numPaths = getNumActivePaths();
+    const auto& targets = targetSettings;
+
+    if (smoothingParameter->load() < 0.5f)
+    {
+        smoothingWasActive = false;
+
+        // The dynamic band's gain changes ramp over the sub-block, as the
+        // chain would for smoothing; anything else jumps.
+        auto rampLength = svfSettingsValid && dynamicStages != 0 ? static_cast<int>(block.getNumSamples()) : 0;
+
+        for (int path = 0; path < numPaths; ++path)
+        {
+            auto target = applyDynamics(targets[path], path);
+
+            if (!svfSettingsValid || target != svfSettings[path])
+            {
+                PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+                svfChain.setParameters(target, rampLength, path);
+                performanceCounters.countCoefficientRedesign();
+                svfSettings[path] = target;
+            }
+        }
+
+        svfSettingsValid = true;
+
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+        svfChain.process(context);
+        return;
+    }
+
+    auto isSmoothing = false;
+
+    for (int path = 0; path < numPaths; ++path)
+    {
+        auto& smoother = smoothers[path];
+
+        if (!smoothingWasActive)
+        {
+            // Ramp from whatever the filters are currently running.
+            smoother.setCurrentAndTarget(svfSettingsValid ? svfSettings[path] : targets[path]);
+
+            if (!svfSettingsValid)
+                svfChain.setParameters(targets[path], 0, path);
+        }
+
+        smoother.setTarget(targets[path]);
+        isSmoothing = isSmoothing || smoother.isSmoothing();
+    }
+
+    smoothingWasActive = true;
+
+    auto numSamples = block.getNumSamples();
+
+    auto pendingDynamicStages = dynamicStages;
+
+    if (!isSmoothing && pendingDynamicStages == 0)
+    {
+        juce::dsp::ProcessContextReplacing<SampleType> context(block);
+        svfChain.process(context);
+        return;
+    }
+
+    // The smoothers are sampled on the sub-block grid; within each sub-block
+    // the chain ramps its g, k and mix gains per sample towards that value.
+    auto interval = static_cast<size_t>(smoothingUpdateInterval.load());
+
+    for (size_t start = 0; start < numSamples; start += interval)
+    {
+        auto length = juce::jmin(interval, numSamples - start);
+
+        for (int path = 0; path < numPaths; ++path)
+        {
+            if ((smoothers[path].advance(static_cast<int>(length)) | pendingDynamicStages) != 0)
+            {
+                PerformanceCounters::ScopedTimer timer(performanceCounters, PerformanceCounters::CoefficientUpdate);
+                svfChain.setParameters(applyDynamics(smoothers[path].getCurrent(), path), static_cast<int>(length), path);
+                performanceCounters.countCoefficientRedesign();
+            }
+        }
+
+        pendingDynamicStages = 0;
+
+        auto subBlock = block.getSubBlock(start, length);
+        juce::dsp::ProcessContextReplacing<SampleType> context(subBlock);
+        svfChain.process(context);
+    }
 
-    updateCoefficients(leftChain.get<ChainPositions::Choose>().coefficients, nocthCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Choose>().coefficients, nocthCoefficients);
+    for (int path = 0; path < numPaths; ++path)
+        svfSettings[path] = applyDynamics(smoothers[path].getCurrent(), path);
 
+    svfSettingsValid = true;
 }
 
-void Project_EEAVAudioProcessor::updateBandPassFilter(const ChainSettings& chainSettings)
+void Project_EEAVAudioProcessor::setSmoothingUpdateInterval(int numSamples) noexcept
 {
+    smoothingUpdateInterval.store(juce::jmax(1, numSamples));
+}
+
+bool Project_EEAVAudioProcessor::scheduleParameterChange(const juce::String& parameterID, float value, int sampleOffset)
+{
+    auto* parameter = apvts.getParameter(parameterID);
+    auto* rawValue = apvts.getRawParameterValue(parameterID);
+
+    if (parameter == nullptr || rawValue == nullptr || sampleOffset < 0)
+        return false;
 
-    auto bandPassCoefficients = makeBandPassFilter(chainSettings, getSampleRate());
+    auto path = getChainPathForParameter(parameterID);
+
+    // Snapped to the parameter's range and steps, so the event holds exactly
+    // what setting the parameter would.
+    value = parameter->convertFrom0to1(parameter->convertTo0to1(value));
+
+    // Only the filter parameters have a place in ChainSettings.
+    ChainSettings scratch;
+
+    if (chainParameters[path].apply(scratch, rawValue, value) == 0)
+        return false;
 
-    updateCoefficients(leftChain.get<ChainPositions::Choose>().coefficients, bandPassCoefficients);
-    updateCoefficients(rightChain.get<ChainPositions::Choose>().coefficients, bandPassCoefficients);
+    return parameterEvents.push({ sampleOffset, path, rawValue, value });
 }
 
-void updateCoefficients(Coefficients & old, const Coefficients & replacements)
+void Project_EEAVAudioProcessor::setMinimumEventSpacing(int numSamples) noexcept
 {
-	*old = *replacements;
+    minimumEventSpacing.store(juce::jmax(1, numSamples));
 }
 
-void Project_EEAVAudioProcessor::updateLowCutFilters(const ChainSettings& chainSettings) 
+void Project_EEAVAudioProcessor::storeSnapshot(int slot)
 {
-	auto lowCutCoefficients = makeLowCutFilter(chainSettings, getSampleRate());
+    ChainSnapshot snapshot;
 
-    auto& leftLowCut = leftChain.get<ChainPositions::LowCut>();
-    auto& rightLowCut = rightChain.get<ChainPositions::LowCut>();
+    for (int path = 0; path < numChainPaths; ++path)
+        snapshot[path] = getChainSettings(apvts, path);
 
-    updateCutFilter(leftLowCut, lowCutCoefficients, static_cast<Slope>(chainSettings.lowCutSlope));
-    updateCutFilter(rightLowCut, lowCutCoefficients, static_cast<Slope>(chainSettings.lowCutSlope));
+    morphEngine.storeSnapshot(slot, snapshot);
 }
 
-void Project_EEAVAudioProcessor::updateHighCutFilters(const ChainSettings& chainSettings)
+bool Project_EEAVAudioProcessor::morphToSnapshot(int slot)
 {
-	auto highCutCoefficients = makeHighCutFilter(chainSettings, getSampleRate());
+    auto target = morphEngine.getSnapshot(slot);
 
-    auto& leftHighCut = leftChain.get<ChainPositions::HighCut>();
-    auto& rightHighCut = rightChain.get<ChainPositions::HighCut>();
+    if (!target.has_value())
+        return false;
+
+    ChainSnapshot settled;
+
+    for (int path = 0; path < numChainPaths; ++path)
+        settled[path] = getChainSettings(apvts, path);
+
+    // The design method is a global parameter rather than part of the
+    // snapshot, so the morph keeps the current one.
+    for (int path = 0; path < numChainPaths; ++path)
+        (*target)[path].designMethod = settled[path].designMethod;
+
+    // Staged before the parameters change, so the audio thread has the
+    // morph by the time the designer has the target's coefficients.
+    morphEngine.startMorph(morphEngine.getCurrentSettings(settled),
+                           *target,
+                           morphTimeParameter->load(),
+                           getFilterSampleRate());
 
-    updateCutFilter(leftHighCut, highCutCoefficients, static_cast<Slope>(chainSettings.highCutSlope));
-    updateCutFilter(rightHighCut, highCutCoefficients, static_cast<Slope>(chainSettings.highCutSlope));
+    for (int path = 0; path < numChainPaths; ++path)
+        setChainSettings(apvts, (*target)[path], path);
+
+    return true;
 }
 
-void Project_EEAVAudioProcessor::updateChooseFilter(const ChainSettings& chainSettings) 
+//==============================================================================
+bool Project_EEAVAudioProcessor::hasEditor() const
 {
+    return true; // (change this to false if you choose to not supply an editor)
+}
 
-    switch (chainSettings.filterName)
-    {
-    case PeakFilter:
+juce::AudioProcessorEditor* Project_EEAVAudioProcessor::createEditor()
+{
+    return new Project_EEAVAudioProcessorEditor (*this);
+    //return new juce::GenericAudioProcessorEditor(*this);
+}
+
+//==============================================================================
+void Project_EEAVAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
+{
+    // The parameters and the snapshot slots, in one fixed-layout binary block.
+    writeBinaryState(getParameters(), morphEngine.getSnapshots(), destData);
+}
+
+void Project_EEAVAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
+{
+    // Only the parameters that differ are set. Their listeners mark just the
+    // stages they affect dirty and update the latency and oversampling, so
+    // nothing else needs redoing.
+    if (isBinaryState(data, sizeInBytes))
     {
-		DBG("Peak Filter Selected");
-        updatePeakFilter(chainSettings);
-        break;
+        SnapshotBank snapshots;
+
+        if (restoreBinaryState(getParameters(), snapshots, data, sizeInBytes) >= 0)
+            morphEngine.setSnapshots(snapshots);
+
+        return;
     }
-    case NotchFilter:
+
+    // A ValueTree stream from before the binary format.
+	auto tree = juce::ValueTree::readFromData(data, sizeInBytes);
+    if (tree.isValid())
     {
-		DBG("Notch Filter Selected");
-        updateNotchFilter(chainSettings);
-        break;
+		apvts.replaceState(tree);
+        morphEngine.setSnapshots({});
+        // The design worker picks this up and hands the result to the audio thread.
+        coefficientDesigner.markAllDirty();
+        linearPhaseDesigner.markDirty();
+
+        // The restored state may select a different oversampling factor,
+        // and engine, so the latency is reported again with it.
+        reprepareRequested.store(true);
+        triggerAsyncUpdate();
     }
-    case BandPassFilter:
+}
+
+void Project_EEAVAudioProcessor::applyCoefficients(const PathCoefficients& coefficients) noexcept
+{
+    performanceCounters.countCoefficientRedesign();
+
+    // Only the engines in the current precision run, so only they need it.
+    if (isUsingDoublePrecision())
+        doubleEngines.filterChain.setCoefficients(coefficients);
+    else
+        floatEngines.filterChain.setCoefficients(coefficients);
+}
+
+void Project_EEAVAudioProcessor::parameterChanged(const juce::String& parameterID, float newValue)
+{
+    // Only read when a morph starts, or by the dynamic band's detector.
+    if (parameterID == "Morph Time" || parameterID.startsWith("Dynamic"))
+        return;
+
+    // The design method applies to both paths.
+    if (parameterID == "Design")
+        coefficientDesigner.markAllDirty();
+    else
+        coefficientDesigner.markDirty(getDirtyStagesForParameter(parameterID), getChainPathForParameter(parameterID));
+
+    // The engine doesn't change the kernel, only whether one is needed.
+    if (parameterID == "Engine")
+        linearPhaseDesigner.engineChanged();
+    else
+        linearPhaseDesigner.markDirty();
+
+    // Both change the latency, which is only reported from the message
+    // thread: this may be the audio thread, and the oversamplers are
+    // replaced by prepareToPlay().
+    if (parameterID == "Oversampling")
+        reprepareRequested.store(true);
+
+    if (parameterID == "Engine" || parameterID == "Oversampling")
+        triggerAsyncUpdate();
+}
+
+void Project_EEAVAudioProcessor::handleAsyncUpdate()
+{
+    auto reprepare = reprepareRequested.exchange(false);
+
+    if (getSampleRate() <= 0.0)
+        return; // Not prepared yet; prepareToPlay will pick the factor and latency up
+
+    if (!reprepare)
     {
-        DBG("Band Pass Filter Selected");
-        updateBandPassFilter(chainSettings);
-        break;
-    }
+        updateLatency();
+        return;
     }
+
+    // A new oversampling factor changes the rate the filters run at, so
+    // everything is prepared again with processing held off meanwhile.
+    suspendProcessing(true);
+    prepareToPlay(getSampleRate(), getBlockSize());
+    suspendProcessing(false);
 }
 
-void Project_EEAVAudioProcessor::updateFilters() 
+void Project_EEAVAudioProcessor::updateLatency()
 {
-	auto chainSettings = getChainSettings(apvts);
+    auto engine = static_cast<int>(engineParameter->load());
 
-    updateLowCutFilters(chainSettings);
-	updateChooseFilter(chainSettings);
-	updateHighCutFilters(chainSettings);
+    if (engine == LinearPhaseEngine)
+        setLatencySamples(linearPhaseDesigner.getKernelLatency() + linearPhaseConvolution.getLatency());
+    else
+        setLatencySamples(juce::roundToInt(getOversamplingLatency()));
+}
+
+double Project_EEAVAudioProcessor::getOversamplingLatency() const noexcept
+{
+    if (floatEngines.oversampling != nullptr)
+        return static_cast<double>(floatEngines.oversampling->getLatencyInSamples());
+
+    if (doubleEngines.oversampling != nullptr)
+        return doubleEngines.oversampling->getLatencyInSamples();
+
+    return 0.0;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout Project_EEAVAudioProcessor::createParameterLayout() 
 {
     //SPEC:
-    //  -3bands: low,high,Parametric/Peak
+    //  -bands: low,high, up to maxBands Parametric/Peak
     //  Cut bands:Controllable Frecuency/Slope
-    //  Parametric bands: Controllable Frequency, Gain, Quality
+    //  Parametric bands: On/Off, Type, Controllable Frequency, Gain, Quality
 
     juce::AudioProcessorValueTreeState::ParameterLayout layout;
 
-    layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq",
-                                                           "LowCut Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 
-                                                           20.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq",
-                                                           "HighCut Freq",
-                                                           juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                           20000.f));
     juce::StringArray filterNames;
     filterNames.add("Peak");
     filterNames.add("Notch");
     filterNames.add("BandPass");
 
-    layout.add(std::make_unique<juce::AudioParameterChoice>("Choose filter", "Choose filter", filterNames, 0));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq",
-                                                            "Peak Freq",
-                                                            juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
-                                                            750.f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain",
-                                                            "Peak Gain",
-                                                            juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
-                                                            0.0f));
-
-    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality",
-                                                            "Peak Quality",
-                                                            juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
-                                                            1.f));
-  
     juce::StringArray stringArray;
     for (int i = 0; i < 4; ++i)
     {
@@ -402,8 +1258,140 @@ juce::AudioProcessorValueTreeState::ParameterLayout Project_EEAVAudioProcessor::
         stringArray.add(str);
     }
 
-	layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope","LowCut Slope",stringArray,0));
-    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+    auto addBandParameters = [&](int path, int band)
+    {
+        auto id = [path, band](const char* band0ParameterID) { return getParameterID(getBandParameterID(band0ParameterID, band), path); };
+
+        // Band 0 keeps its original default; the others start spread evenly
+        // in octaves across the audio range.
+        auto defaultFreq = band == 0 ? 750.f
+                                     : 20.f * std::pow(1000.f, (static_cast<float>(band) + 0.5f) / static_cast<float>(maxBands));
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("Choose filter"), id("Choose filter"), filterNames, 0));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Freq"),
+                                                                id("Peak Freq"),
+                                                                juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                                std::round(defaultFreq)));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Gain"),
+                                                                id("Peak Gain"),
+                                                                juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+                                                                0.0f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("Peak Quality"),
+                                                                id("Peak Quality"),
+                                                                juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+                                                                1.f));
+    };
+
+    auto addChainParameters = [&](int path)
+    {
+        auto id = [path](const char* pathAParameterID) { return getParameterID(pathAParameterID, path); };
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("LowCut Freq"),
+                                                               id("LowCut Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f), 
+                                                               20.f));
+
+        layout.add(std::make_unique<juce::AudioParameterFloat>(id("HighCut Freq"),
+                                                               id("HighCut Freq"),
+                                                               juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+                                                               20000.f));
+
+        addBandParameters(path, 0);
+
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("LowCut Slope"), id("LowCut Slope"), stringArray, 0));
+        layout.add(std::make_unique<juce::AudioParameterChoice>(id("HighCut Slope"), id("HighCut Slope"), stringArray, 0));
+    };
+
+    addChainParameters(PathA);
+
+    // The TPT engine makes per-sample smoothing cheap, so both are on by default.
+    layout.add(std::make_unique<juce::AudioParameterBool>("Smoothing", "Smoothing", true));
+
+    juce::StringArray engineNames;
+    engineNames.add("Biquad");
+    engineNames.add("TPT");
+    engineNames.add("Linear Phase");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Engine", "Engine", engineNames, TPTEngine));
+
+    // Index is the log2 of the factor.
+    juce::StringArray oversamplingNames;
+    oversamplingNames.add("Off");
+    oversamplingNames.add("2x");
+    oversamplingNames.add("4x");
+    oversamplingNames.add("8x");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", oversamplingNames, 0));
+
+    // Added after everything else so existing parameters keep their indices.
+    // Path B only has an effect while the "Stereo Mode" splits the paths.
+    juce::StringArray stereoModeNames;
+    stereoModeNames.add("Stereo");
+    stereoModeNames.add("Left/Right");
+    stereoModeNames.add("Mid/Side");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode", stereoModeNames, StereoLinked));
+
+    addChainParameters(PathB);
+
+    // Band 0 is on by default, like the single band it replaces; the rest
+    // are off, and cost nothing until they are switched on.
+    for (int path = 0; path < numChainPaths; ++path)
+    {
+        for (int band = 0; band < maxBands; ++band)
+        {
+            auto onID = getParameterID(getBandParameterID("Peak On", band), path);
+            layout.add(std::make_unique<juce::AudioParameterBool>(onID, onID, band == 0));
+
+            if (band > 0)
+                addBandParameters(path, band);
+        }
+    }
+
+    // Seconds morphToSnapshot() takes to reach the slot's settings. The
+    // linear phase engine doesn't morph: it crossfades to the slot's kernel.
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Morph Time",
+                                                           "Morph Time",
+                                                           juce::NormalisableRange<float>(0.f, 10.f, 0.01f, 0.3f),
+                                                           1.f));
+
+    // The dynamic band: each path's band 0 gain drops by the gain change its
+    // own detector finds at that band, keyed by the input or, with
+    // "Dynamic Sidechain", the sidechain bus.
+    layout.add(std::make_unique<juce::AudioParameterBool>("Dynamic", "Dynamic", false));
+    layout.add(std::make_unique<juce::AudioParameterBool>("Dynamic Sidechain", "Dynamic Sidechain", false));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Threshold",
+                                                           "Dynamic Threshold",
+                                                           juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+                                                           -20.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Ratio",
+                                                           "Dynamic Ratio",
+                                                           juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f),
+                                                           4.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Attack",
+                                                           "Dynamic Attack",
+                                                           juce::NormalisableRange<float>(0.5f, 200.f, 0.1f, 0.3f),
+                                                           5.f));
+
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Dynamic Release",
+                                                           "Dynamic Release",
+                                                           juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.3f),
+                                                           100.f));
+
+    // How the biquads are designed: the bilinear transform, or matched to
+    // the analog magnitude so that bands near Nyquist keep their shape. The
+    // TPT engine has only its bilinear-equivalent design and ignores it.
+    juce::StringArray designNames;
+    designNames.add("Bilinear");
+    designNames.add("Matched");
+
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Design", "Design", designNames, BilinearDesign));
 
     return layout;
 }
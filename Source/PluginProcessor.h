@@ -10,109 +10,26 @@
 
 #include <JuceHeader.h>
 
-enum Slope {
-	Slope_12,
-	Slope_24,
-	Slope_36,
-	Slope_48
-};
-
-enum FilterType
-{
-	PeakFilter,
-	NotchFilter,
-	BandPassFilter
-};
-
-struct ChainSettings
-{
-	float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-	int filterName{ FilterType::PeakFilter };
-	float lowCutFreq{ 0 }, highCutFreq{ 0 };
-	int lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-};
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
-using Filter = juce::dsp::IIR::Filter<float>;
-
-using CutFilter = juce::dsp::ProcessorChain <Filter, Filter, Filter, Filter>;
-
-using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
-
-enum ChainPositions
-{
-    LowCut,
-    Choose,
-	HighCut
-};
-
-using Coefficients = Filter::CoefficientsPtr;
-void updateCoefficients(Coefficients& old, const Coefficients& replacement);
-
-Coefficients makePeakFilter(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makeNotchFilter(const ChainSettings& chainSettings, double sampleRate);
-Coefficients makeBandPassFilter(const ChainSettings& chainSettings, double sampleRate);
-
-Coefficients makeChooseFilter(const ChainSettings& chainSettings, double sampleRate);
-
-template<int Index, typename ChainType, typename CoefficientType>
-void update(ChainType& chain, const CoefficientType& coefficients)
-{
-    updateCoefficients(chain.template get<Index>().coefficients, coefficients[Index]);
-    chain.template setBypassed<Index>(false);
-}
-
-template<typename ChainType, typename CoefficientType>
-void updateCutFilter(ChainType& leftLowCut,
-    const CoefficientType& cutCoefficients,
-    const Slope& lowCutSlope)
-{
-    leftLowCut.template setBypassed<0>(true);
-    leftLowCut.template setBypassed<1>(true);
-    leftLowCut.template setBypassed<2>(true);
-    leftLowCut.template setBypassed<3>(true);
-
-    switch (lowCutSlope)
-    {
-    case Slope_48:
-    {
-        update<3>(leftLowCut, cutCoefficients);
-    }
-    case Slope_36:
-    {
-        update<2>(leftLowCut, cutCoefficients);
-    }
-    case Slope_24:
-    {
-        update<1>(leftLowCut, cutCoefficients);
-    }
-    case Slope_12:
-    {
-        update<0>(leftLowCut, cutCoefficients);
-        break;
-    }
-
-    }
-}
-
-inline auto makeLowCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-	return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-        sampleRate,
-        2 * (chainSettings.lowCutSlope + 1));
-}
+#include "FilterDesign.h"
+#include "CoefficientDesigner.h"
+#include "SIMDFilterChain.h"
+#include "SVFFilterChain.h"
+#include "LinearPhaseDesigner.h"
+#include "ChainSettingsSmoother.h"
+#include "AnalyserFifo.h"
+#include "SilenceDetector.h"
+#include "ParameterEventQueue.h"
+#include "PerformanceCounters.h"
+#include "BinaryState.h"
+#include "MorphEngine.h"
+#include "DynamicBand.h"
 
-inline auto makeHighCutFilter(const ChainSettings& chainSettings, double sampleRate)
-{
-    return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-        sampleRate,
-        2 * (chainSettings.highCutSlope + 1));
-}
 //==============================================================================
 /**
 */
-class Project_EEAVAudioProcessor  : public juce::AudioProcessor
+class Project_EEAVAudioProcessor  : public juce::AudioProcessor,
+                                    private juce::AudioProcessorValueTreeState::Listener,
+                                    private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -128,6 +45,10 @@ public:
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+
+    // Both IIR engines run natively in double when the host asks for it.
+    bool supportsDoublePrecisionProcessing() const override { return true; }
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -152,23 +73,253 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    // Widest bus accepted, enough for 7.1.4. Every channel gets the same
+    // filters; the IIR engines run them SIMDFilterChain<>::channelsPerGroup
+    // channels at a time.
+    static constexpr int maxChannels = 12;
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts{ *this,nullptr,"Parameters",createParameterLayout()};
 
+    // Number of samples between coefficient updates while "Smoothing" is on
+    // and a parameter is ramping.
+    void setSmoothingUpdateInterval(int numSamples) noexcept;
+
+    // Sample accurate automation. JUCE hands a plugin no timestamped
+    // parameter changes, so whoever calls processBlock() schedules them here
+    // first, in order of sampleOffset: the filter parameter `parameterID`
+    // takes `value` (in its own range) from `sampleOffset` samples into the
+    // next processBlock(). The IIR engines split that block at the offset;
+    // offsets past its end are applied at its last sample.
+    //
+    // The events only last for that block. Set the parameters themselves to
+    // the final values afterwards, as a host's automation would, or the next
+    // block goes back to the old ones.
+    //
+    // Returns false for anything but a filter parameter, or if the queue is
+    // full. Looks the ID up, so call it from the thread calling processBlock(),
+    // never from inside it.
+    bool scheduleParameterChange(const juce::String& parameterID, float value, int sampleOffset);
+
+    // Events less than this many samples after the previous split are applied
+    // with it rather than getting a sub-block of their own, which bounds the
+    // number of sub-blocks to one per `numSamples`. 1 splits at every offset.
+    void setMinimumEventSpacing(int numSamples) noexcept;
+
+    // Snapshot slots, from 0 to numSnapshots - 1. Storing one copies both
+    // paths' current filter settings into it; they are saved with the state.
+    // Message thread.
+    void storeSnapshot(int slot);
+    bool hasSnapshot(int slot) const { return morphEngine.getSnapshot(slot).has_value(); }
+
+    // Moves the filters from wherever they are now to the slot's settings
+    // over "Morph Time", and sets the filter parameters to them straight
+    // away. The IIR engines follow a path staged here, so the audio thread
+    // only interpolates: coefficients for the biquads, settings for the TPT
+    // engine. The linear phase engine can't follow a moving response, so it
+    // switches to the slot's kernel with the convolution's crossfade instead.
+    // Returns false if the slot is empty. Message thread.
+    bool morphToSnapshot(int slot);
+
+    // The spectrum analyser's FIFOs are only fed while at least one
+    // consumer (an open editor) is registered.
+    void addAnalyserConsumer() noexcept { ++analyserConsumers; }
+    void removeAnalyserConsumer() noexcept { --analyserConsumers; }
+
+    // Rate the IIR filters run at: the host rate times the oversampling
+    // factor. The linear phase kernel is designed at this rate too.
+    double getFilterSampleRate() const noexcept { return filterSampleRate.load(); }
+
+    AnalyserFifo& getPreEQFifo() noexcept { return preEQFifo; }
+    AnalyserFifo& getPostEQFifo() noexcept { return postEQFifo; }
+
+    // Always running; the editor shows them and can dump them to a file.
+    PerformanceCounters& getPerformanceCounters() noexcept { return performanceCounters; }
+
 private:
-	MonoChain leftChain, rightChain;
+    static constexpr double smoothingRampSeconds = 0.05;
+
+    // The IIR engines in one sample type. Only the set matching the host's
+    // processing precision is prepared and run; the coefficients, designers
+    // and smoothers are shared.
+    template <typename SampleType>
+    struct FilterEngines
+    {
+        SIMDFilterChain<SampleType> filterChain;
+        SVFFilterChain<SampleType> svfChain;
+
+        // Null when "Oversampling" is off. A new factor only takes effect in
+        // prepareToPlay(), which handleAsyncUpdate() calls again for it.
+        std::unique_ptr<juce::dsp::Oversampling<SampleType>> oversampling;
+
+        void prepare(const juce::dsp::ProcessSpec& hostSpec, size_t oversamplingFactorLog2);
+    };
+
+    FilterEngines<float> floatEngines;
+    FilterEngines<double> doubleEngines;
+
+    template <typename SampleType>
+    FilterEngines<SampleType>& getEngines() noexcept;
+
+    // Declared before its designer, which holds a reference to it.
+    MultiChannelConvolution linearPhaseConvolution;
+    LinearPhaseDesigner linearPhaseDesigner{ apvts, linearPhaseConvolution };
+
+    std::atomic<double> filterSampleRate{ 44100.0 };
+
+    // The convolution only runs in float; double buffers go through this.
+    juce::AudioBuffer<float> linearPhaseBuffer;
+
+    std::atomic<float>* engineParameter{ apvts.getRawParameterValue("Engine") };
+    FilterEngine activeEngine{ BiquadEngine };
+
+    std::atomic<float>* stereoModeParameter{ apvts.getRawParameterValue("Stereo Mode") };
+    StereoMode activeStereoMode{ StereoLinked };
+
+    // Read once per block for each path in use.
+    std::array<ChainParameters, numChainPaths> chainParameters{ { ChainParameters(apvts, PathA),
+                                                                  ChainParameters(apvts, PathB) } };
+
+    CoefficientDesigner coefficientDesigner{ apvts };
+
+    std::atomic<float>* smoothingParameter{ apvts.getRawParameterValue("Smoothing") };
+
+    // The ring down is measured to 120 dB below the input, plus the most a
+    // band can boost, so it is below -120 dB at the output.
+    static constexpr double ringDownAttenuationInDecibels = 144.0;
+
+    SilenceDetector silenceDetector;
+
+    // One per path; path B's only runs while the paths are split.
+    std::array<ChainSettingsSmoother, numChainPaths> smoothers;
+    PathCoefficients smoothedCoefficients;
+    bool smoothingWasActive{ false };
+    std::atomic<int> smoothingUpdateInterval{ 32 };
+
+    ParameterEventQueue parameterEvents;
+    std::array<ParameterEvent, ParameterEventQueue::capacity> blockEvents;
+    int numBlockEvents{ 0 };
+    std::atomic<int> minimumEventSpacing{ 16 };
+
+    // The parameters, with the events so far in this block applied. What the
+    // smoothers and the SVF chain aim for.
+    std::array<ChainSettings, numChainPaths> targetSettings;
+
+    // The biquads are running coefficients calculated here, for events or
+    // the dynamic band, rather than the designer's.
+    bool eventCoefficientsActive{ false };
+
+    // Stages whose running coefficients came from events rather than the
+    // parameters, to be put back when the next block starts.
+    int eventStages{ 0 };
+
+    AnalyserFifo preEQFifo, postEQFifo;
+    PerformanceCounters performanceCounters;
+    std::atomic<int> analyserConsumers{ 0 };
+
+    MorphEngine morphEngine;
+    std::atomic<float>* morphTimeParameter{ apvts.getRawParameterValue("Morph Time") };
+
+    // The morph the IIR engines are following, or nullptr, and how far along it
+    // they are, in keyframes.
+    const MorphEngine::MorphPath* activeMorph{ nullptr };
+    double morphPosition{ 0.0 };
+
+    // "Dynamic" turns band 0 of each path into a dynamic band, keyed by the
+    // input or the sidechain bus and detected in that path's own band 0.
+    std::array<DynamicBand, numChainPaths> dynamicBands;
+    std::atomic<float>* dynamicParameter{ apvts.getRawParameterValue("Dynamic") };
+    std::atomic<float>* dynamicSidechainParameter{ apvts.getRawParameterValue("Dynamic Sidechain") };
+    std::atomic<float>* dynamicThresholdParameter{ apvts.getRawParameterValue("Dynamic Threshold") };
+    std::atomic<float>* dynamicRatioParameter{ apvts.getRawParameterValue("Dynamic Ratio") };
+    std::atomic<float>* dynamicAttackParameter{ apvts.getRawParameterValue("Dynamic Attack") };
+    std::atomic<float>* dynamicReleaseParameter{ apvts.getRawParameterValue("Dynamic Release") };
 
-	
-    void updatePeakFilter(const ChainSettings &chainSettings);
-    void updateNotchFilter(const ChainSettings& chainSettings);
-    void updateBandPassFilter(const ChainSettings& chainSettings);
+    // Smaller moves of the detector's gain are left out, which bounds the
+    // coefficient updates to those that can be heard.
+    static constexpr float dynamicGainStepInDecibels = 0.1f;
 
-	void updateLowCutFilters(const ChainSettings& chainSettings);
-    void updateHighCutFilters(const ChainSettings& chainSettings);
+    // Whether this block runs the dynamic band, the gain change each path's
+    // filters have now, and the stages still to be updated for them.
+    bool dynamicsActive{ false };
+    std::array<float, numChainPaths> dynamicGainsInDecibels{};
+    int dynamicStages{ 0 };
 
-    void updateChooseFilter(const ChainSettings& chainSettings);
+    // Host rate samples per detector gain, taken from the smoothing update
+    // interval at the start of the block.
+    int dynamicUpdateInterval{ 32 };
+
+    // What svfChain was last told, so unchanged blocks cost nothing.
+    std::array<ChainSettings, numChainPaths> svfSettings;
+    bool svfSettingsValid{ false };
+
+    void parameterChanged(const juce::String& parameterID, float newValue) override;
 
-    void updateFilters();
+    // Reports the latency again, and also prepares everything again if
+    // reprepareRequested is set, for a new oversampling factor.
+    void handleAsyncUpdate() override;
+    std::atomic<bool> reprepareRequested{ false };
+
+    void applyCoefficients(const PathCoefficients& coefficients) noexcept;
+    void recalculateCoefficients() noexcept;
+
+    // Path B only costs anything while the "Stereo Mode" splits the paths.
+    int getNumActivePaths() const noexcept { return activeStereoMode != StereoLinked ? numChainPaths : 1; }
+
+    template <typename SampleType>
+    void processSamples(juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    void processLinearPhase(juce::dsp::AudioBlock<float>& block) noexcept;
+    void processLinearPhase(juce::dsp::AudioBlock<double>& block) noexcept;
+
+    // Runs an IIR engine over `block`, at the filter rate, split at this
+    // block's parameter events.
+    template <typename SampleType>
+    void processFilterEngine(juce::dsp::AudioBlock<SampleType>& block, FilterEngine engine, size_t oversamplingFactor) noexcept;
+
+    template <typename SampleType>
+    void processWithDesignedCoefficients(juce::dsp::AudioBlock<SampleType>& block) noexcept;
+    template <typename SampleType>
+    void processSmoothed(juce::dsp::AudioBlock<SampleType>& block) noexcept;
+    // Runs the dynamic band's detector over this block's key, at the host
+    // rate, before `input` is filtered.
+    template <typename SampleType>
+    void detectDynamics(juce::AudioBuffer<SampleType>& buffer, const juce::dsp::AudioBlock<SampleType>& input) noexcept;
+
+    // Moves the filters' gain change to the detector's, for the sub-block at
+    // `hostSample`, if it has moved by at least dynamicGainStepInDecibels.
+    void updateDynamicGain(int hostSample) noexcept;
+
+    // `settings` with the dynamic band's gain change applied.
+    ChainSettings applyDynamics(ChainSettings settings, int path) const noexcept;
+
+    // Runs `engine`, the biquads or the TPT engine, along the active morph.
+    template <typename SampleType>
+    void processMorph(juce::dsp::AudioBlock<SampleType>& block, FilterEngine engine) noexcept;
+    template <typename SampleType>
+    void processWithStateVariableFilters(juce::dsp::AudioBlock<SampleType>& block) noexcept;
+
+    void switchEngine(FilterEngine newEngine) noexcept;
+
+    // Drops the morph, if any, and puts the biquads on the parameters' own
+    // coefficients, which the morph ends on.
+    void finishMorph() noexcept;
+    void switchStereoMode(StereoMode newStereoMode) noexcept;
+
+    // Samples, at the host rate, until the given engine's output has decayed
+    // below -120 dB after the input stops. Allocation free; the IIR engines'
+    // figure comes from the poles of the current settings.
+    int getRingDownSamples(FilterEngine engine, int numPaths) const noexcept;
+    double getOversamplingLatency() const noexcept;
+
+    // Clears every filter's state, for when the silence detector starts
+    // skipping blocks.
+    void flushFilters() noexcept;
+
+    // Reports the linear phase kernel's delay while that engine is selected,
+    // or the oversampling filters' delay while an IIR engine is. Only from
+    // prepareToPlay() and handleAsyncUpdate().
+    void updateLatency();
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Project_EEAVAudioProcessor)
 };
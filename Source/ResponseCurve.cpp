@@ -0,0 +1,94 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.cpp
+    Magnitude response of the filter chain on a fixed per-pixel frequency
+    grid, for drawing.
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+
+void ResponseCurve::setSize(int numPixels, double sampleRate)
+{
+    numPixels = juce::jmax(0, numPixels);
+
+    if (numPixels == getNumPixels() && sampleRate == tableSampleRate)
+        return;
+
+    tableSampleRate = sampleRate;
+
+    auto numRegisters = (static_cast<size_t>(numPixels) + lanes - 1) / lanes;
+
+    phi.assign(numRegisters, SIMDDouble::expand(0.0));
+    numerator.assign(numRegisters, SIMDDouble::expand(1.0));
+    denominator.assign(numRegisters, SIMDDouble::expand(1.0));
+    magnitudesInDecibels.assign(static_cast<size_t>(numPixels), 0.f);
+
+    auto* phiValues = reinterpret_cast<double*>(phi.data());
+
+    for (int i = 0; i < numPixels; ++i)
+    {
+        auto frequency = juce::mapToLog10(double(i) / double(numPixels), 20.0, 20000.0);
+        auto halfOmega = juce::MathConstants<double>::pi * frequency / sampleRate;
+        auto sine = std::sin(halfOmega);
+
+        phiValues[i] = sine * sine;
+    }
+}
+
+void ResponseCurve::multiplySection(const BiquadCoefficients& section) noexcept
+{
+    double b0 = section.b0, b1 = section.b1, b2 = section.b2;
+    double a1 = section.a1, a2 = section.a2;
+
+    auto bSum = b0 + b1 + b2;
+    auto aSum = 1.0 + a1 + a2;
+
+    auto n0 = SIMDDouble::expand(bSum * bSum);
+    auto n1 = SIMDDouble::expand(-4.0 * (b0 * b1 + 4.0 * b0 * b2 + b1 * b2));
+    auto n2 = SIMDDouble::expand(16.0 * b0 * b2);
+
+    auto d0 = SIMDDouble::expand(aSum * aSum);
+    auto d1 = SIMDDouble::expand(-4.0 * (a1 + 4.0 * a2 + a1 * a2));
+    auto d2 = SIMDDouble::expand(16.0 * a2);
+
+    // Numerators and denominators are accumulated separately, so there is
+    // a single division per pixel at the end.
+    for (size_t i = 0; i < phi.size(); ++i)
+    {
+        auto p = phi[i];
+
+        numerator[i] = numerator[i] * (n0 + p * (n1 + p * n2));
+        denominator[i] = denominator[i] * (d0 + p * (d1 + p * d2));
+    }
+}
+
+void ResponseCurve::update(const ChainCoefficients& coefficients) noexcept
+{
+    std::fill(numerator.begin(), numerator.end(), SIMDDouble::expand(1.0));
+    std::fill(denominator.begin(), denominator.end(), SIMDDouble::expand(1.0));
+
+    for (int i = 0; i < coefficients.lowCut.numSections; ++i)
+        multiplySection(coefficients.lowCut.sections[i]);
+
+    for (int band = 0; band < maxBands; ++band)
+        if (coefficients.bandEnabled[band])
+            multiplySection(coefficients.bands[band]);
+
+    for (int i = 0; i < coefficients.highCut.numSections; ++i)
+        multiplySection(coefficients.highCut.sections[i]);
+
+    const auto* numeratorValues = reinterpret_cast<const double*>(numerator.data());
+    const auto* denominatorValues = reinterpret_cast<const double*>(denominator.data());
+
+    // Same -100 dB floor as Decibels::gainToDecibels.
+    constexpr double minimumPower = 1.0e-10;
+
+    for (size_t i = 0; i < magnitudesInDecibels.size(); ++i)
+    {
+        auto power = numeratorValues[i] / denominatorValues[i];
+        magnitudesInDecibels[i] = static_cast<float>(10.0 * std::log10(juce::jmax(power, minimumPower)));
+    }
+}
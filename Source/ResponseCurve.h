@@ -0,0 +1,56 @@
+/*
+  ==============================================================================
+
+    ResponseCurve.h
+    Magnitude response of the filter chain on a fixed per-pixel frequency
+    grid, for drawing.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    Evaluates |H|^2 of every biquad in a ChainCoefficients at log spaced
+    frequencies from 20 Hz to 20 kHz, one per pixel.
+
+    Using phi = sin^2(w / 2), the squared magnitude of a biquad is a ratio of
+    two quadratics in phi:
+
+        |H|^2 = ((b0 + b1 + b2)^2 - 4 (b0 b1 + 4 b0 b2 + b1 b2) phi + 16 b0 b2 phi^2)
+              / ((1 + a1 + a2)^2 - 4 (a1 + 4 a2 + a1 a2) phi + 16 a2 phi^2)
+
+    The phi table only depends on the width and the sample rate, so an update
+    costs two Horner steps per section and pixel, evaluated several pixels at
+    a time in SIMD registers, plus one log per pixel. This form is also free
+    of the cancellation that 1 - cos(w) suffers from at low frequencies.
+*/
+class ResponseCurve
+{
+public:
+    // Rebuilds the frequency table if the width or sample rate changed.
+    void setSize(int numPixels, double sampleRate);
+
+    // Recomputes the magnitudes for `coefficients` into the cached buffer.
+    void update(const ChainCoefficients& coefficients) noexcept;
+
+    int getNumPixels() const noexcept { return static_cast<int>(magnitudesInDecibels.size()); }
+
+    // One value per pixel, valid after update().
+    const std::vector<float>& getMagnitudesInDecibels() const noexcept { return magnitudesInDecibels; }
+
+private:
+    using SIMDDouble = juce::dsp::SIMDRegister<double>;
+    static constexpr size_t lanes = SIMDDouble::SIMDNumElements;
+
+    void multiplySection(const BiquadCoefficients& section) noexcept;
+
+    double tableSampleRate{ 0.0 };
+
+    std::vector<SIMDDouble> phi, numerator, denominator;
+    std::vector<float> magnitudesInDecibels;
+};
@@ -0,0 +1,280 @@
+/*
+  ==============================================================================
+
+    SIMDFilterChain.cpp
+    LowCut -> bands -> HighCut cascade running groups of channels at once,
+    one channel per SIMD lane.
+
+  ==============================================================================
+*/
+
+#include "SIMDFilterChain.h"
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    auto numGroups = (static_cast<size_t>(spec.numChannels) + channelsPerGroup - 1) / channelsPerGroup;
+
+    groupStates.resize(juce::jmax(static_cast<size_t>(1), numGroups));
+    interleaved.assign(spec.maximumBlockSize, SIMDSample::expand(SampleType(0)));
+
+    for (auto& coefficients : pathCoefficients)
+        coefficients = {};
+
+    updateSections();
+    reset();
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::reset() noexcept
+{
+    for (auto& states : groupStates)
+        for (auto& state : states)
+            state.z1 = state.z2 = SIMDSample::expand(SampleType(0));
+}
+
+template <typename SampleType>
+typename SIMDFilterChain<SampleType>::Section SIMDFilterChain<SampleType>::makeSection(const BiquadCoefficients& coefficients) noexcept
+{
+    return { SIMDSample::expand(static_cast<SampleType>(coefficients.b0)),
+             SIMDSample::expand(static_cast<SampleType>(coefficients.b1)),
+             SIMDSample::expand(static_cast<SampleType>(coefficients.b2)),
+             SIMDSample::expand(static_cast<SampleType>(coefficients.a1)),
+             SIMDSample::expand(static_cast<SampleType>(coefficients.a2)) };
+}
+
+template <typename SampleType>
+typename SIMDFilterChain<SampleType>::Section SIMDFilterChain<SampleType>::makeSection(const BiquadCoefficients& pathA, const BiquadCoefficients& pathB) noexcept
+{
+    auto section = makeSection(pathA);
+
+    section.b0.set(1, static_cast<SampleType>(pathB.b0));
+    section.b1.set(1, static_cast<SampleType>(pathB.b1));
+    section.b2.set(1, static_cast<SampleType>(pathB.b2));
+    section.a1.set(1, static_cast<SampleType>(pathB.a1));
+    section.a2.set(1, static_cast<SampleType>(pathB.a2));
+
+    return section;
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::setCoefficients(const PathCoefficients& coefficients) noexcept
+{
+    pathCoefficients = coefficients;
+    updateSections();
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::setStereoMode(StereoMode newStereoMode) noexcept
+{
+    stereoMode = newStereoMode;
+    updateSections();
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::updateSections() noexcept
+{
+    const auto& a = pathCoefficients[PathA];
+    const auto& b = pathCoefficients[PathB];
+    auto split = stereoMode != StereoLinked;
+
+    // A section only one path uses passes the other path's lane through.
+    const BiquadCoefficients passThrough;
+
+    auto update = [&](int index, const BiquadCoefficients* pathA, const BiquadCoefficients* pathB)
+    {
+        sections[index] = makeSection(pathA != nullptr ? *pathA : passThrough);
+        frontSections[index] = split ? makeSection(pathA != nullptr ? *pathA : passThrough,
+                                                   pathB != nullptr ? *pathB : passThrough)
+                                     : sections[index];
+        activeSections[numActiveSections++] = index;
+    };
+
+    auto numLowCut = split ? juce::jmax(a.lowCut.numSections, b.lowCut.numSections) : a.lowCut.numSections;
+    auto numHighCut = split ? juce::jmax(a.highCut.numSections, b.highCut.numSections) : a.highCut.numSections;
+
+    numActiveSections = 0;
+
+    for (int i = 0; i < numLowCut; ++i)
+        update(firstLowCutSection + i,
+               i < a.lowCut.numSections ? &a.lowCut.sections[i] : nullptr,
+               i < b.lowCut.numSections ? &b.lowCut.sections[i] : nullptr);
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        auto enabledA = a.bandEnabled[band];
+        auto enabledB = split && b.bandEnabled[band];
+
+        if (enabledA || enabledB)
+            update(firstBandSection + band,
+                   enabledA ? &a.bands[band] : nullptr,
+                   enabledB ? &b.bands[band] : nullptr);
+    }
+
+    for (int i = 0; i < numHighCut; ++i)
+        update(firstHighCutSection + i,
+               i < a.highCut.numSections ? &a.highCut.sections[i] : nullptr,
+               i < b.highCut.numSections ? &b.highCut.sections[i] : nullptr);
+
+    // Consecutive active sections are fused regardless of which stage they
+    // belong to; only the cascade length has to be known at compile time.
+    static constexpr CascadeFunction cascadeFunctions[maxCascadeLength] = { &processCascade<1>,
+                                                                            &processCascade<2>,
+                                                                            &processCascade<3>,
+                                                                            &processCascade<4> };
+    numCascades = 0;
+
+    for (int first = 0; first < numActiveSections; first += maxCascadeLength)
+    {
+        auto length = juce::jmin(maxCascadeLength, numActiveSections - first);
+        cascades[numCascades++] = { cascadeFunctions[length - 1], first };
+    }
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    auto numChannels = block.getNumChannels();
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    jassert(numChannels <= groupStates.size() * channelsPerGroup);
+    jassert(numSamples <= static_cast<int>(interleaved.size()));
+
+    if (context.isBypassed || numSamples == 0)
+        return;
+
+    for (size_t group = 0; group * channelsPerGroup < numChannels; ++group)
+    {
+        auto firstChannel = group * channelsPerGroup;
+        auto& states = groupStates[group];
+
+        const auto& groupSections = group == 0 ? frontSections : sections;
+
+        interleave(block, firstChannel);
+
+        for (int i = 0; i < numCascades; ++i)
+            cascades[i].process(groupSections, states, &activeSections[cascades[i].firstActiveSection],
+                                interleaved.data(), numSamples);
+
+        deinterleave(block, firstChannel);
+    }
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) noexcept
+{
+    auto* lanes = reinterpret_cast<SampleType*>(interleaved.data());
+    auto numChannels = juce::jmin(block.getNumChannels() - firstChannel, static_cast<size_t>(channelsPerGroup));
+    auto numSamples = block.getNumSamples();
+    size_t channel = 0;
+
+    if (firstChannel == 0 && numChannels >= 2 && stereoMode == MidSide)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            lanes[i * channelsPerGroup] = SampleType(0.5) * (left[i] + right[i]);
+            lanes[i * channelsPerGroup + 1] = SampleType(0.5) * (left[i] - right[i]);
+        }
+
+        channel = 2;
+    }
+
+    for (; channel < numChannels; ++channel)
+    {
+        auto* source = block.getChannelPointer(firstChannel + channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            lanes[i * channelsPerGroup + channel] = source[i];
+    }
+}
+
+template <typename SampleType>
+void SIMDFilterChain<SampleType>::deinterleave(juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) const noexcept
+{
+    auto* lanes = reinterpret_cast<const SampleType*>(interleaved.data());
+    auto numChannels = juce::jmin(block.getNumChannels() - firstChannel, static_cast<size_t>(channelsPerGroup));
+    auto numSamples = block.getNumSamples();
+    size_t channel = 0;
+
+    if (firstChannel == 0 && numChannels >= 2 && stereoMode == MidSide)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto mid = lanes[i * channelsPerGroup];
+            auto side = lanes[i * channelsPerGroup + 1];
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+
+        channel = 2;
+    }
+
+    for (; channel < numChannels; ++channel)
+    {
+        auto* destination = block.getChannelPointer(firstChannel + channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = lanes[i * channelsPerGroup + channel];
+    }
+}
+
+template <typename SampleType>
+template <size_t... SectionIndex>
+void SIMDFilterChain<SampleType>::processCascade(const SectionArray& sections,
+                                                 GroupStates& states,
+                                                 const int* indices,
+                                                 SIMDSample* samples,
+                                                 int numSamples,
+                                                 std::index_sequence<SectionIndex...>) noexcept
+{
+    constexpr auto length = sizeof...(SectionIndex);
+
+    // Copied into locals so that the compiler can keep them in registers
+    // for the whole block rather than reloading them per sample.
+    const std::array<Section, length> c{ { sections[indices[SectionIndex]]... } };
+    std::array<State, length> z{ { states[indices[SectionIndex]]... } };
+
+    auto tick = [](const Section& section, State& state, SIMDSample input) noexcept
+    {
+        auto output = section.b0 * input + state.z1;
+
+        state.z1 = section.b1 * input - section.a1 * output + state.z2;
+        state.z2 = section.b2 * input - section.a2 * output;
+
+        return output;
+    };
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto sample = samples[i];
+
+        // Expands to one tick per section, in order: no loop to unroll.
+        ((sample = tick(c[SectionIndex], z[SectionIndex], sample)), ...);
+
+        samples[i] = sample;
+    }
+
+    ((states[indices[SectionIndex]] = z[SectionIndex]), ...);
+}
+
+template <typename SampleType>
+template <int length>
+void SIMDFilterChain<SampleType>::processCascade(const SectionArray& sections,
+                                                 GroupStates& states,
+                                                 const int* indices,
+                                                 SIMDSample* samples,
+                                                 int numSamples) noexcept
+{
+    processCascade(sections, states, indices, samples, numSamples, std::make_index_sequence<static_cast<size_t>(length)>());
+}
+
+template class SIMDFilterChain<float>;
+template class SIMDFilterChain<double>;
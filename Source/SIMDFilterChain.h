@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    SIMDFilterChain.h
+    LowCut -> bands -> HighCut cascade running groups of channels at once,
+    one channel per SIMD lane.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    Processes any number of channels through the whole cascade, in groups of
+    SIMDRegister<SampleType>::size() channels. Each group is interleaved into SIMD
+    lanes, every active biquad section runs once for all of its lanes, and
+    the result is de-interleaved back into the block. Coefficients are
+    broadcast once and shared by every group; only the filter state is per
+    group.
+
+    Unless the StereoMode is StereoLinked, the first group has its own
+    coefficients with path B in lane 1, so left/right or mid/side are
+    filtered independently in the same pass. The mid/side matrix is folded
+    into that group's interleave and de-interleave, so it costs no extra
+    pass over the buffer.
+
+    Sections are transposed direct form II, like juce::dsp::IIR::Filter.
+    Bypassed cut sections and disabled bands are dropped from the active list
+    rather than being tested per sample, so the cost follows the number of
+    sections actually in use.
+
+    The active sections run as fused cascades of up to maxCascadeLength:
+    each cascade is a separate instantiation that keeps every section's
+    state in locals and makes a single pass over the samples. The cascades
+    are picked when the coefficients or the StereoMode change, never while
+    processing, so a 12 dB/oct cut costs exactly one biquad.
+
+    Instantiated for float and double. The coefficients are designed in
+    double either way and rounded once, when they are loaded, so the float
+    version's inner loop is unchanged; a double group holds half as many
+    channels.
+*/
+template <typename SampleType>
+class SIMDFilterChain
+{
+public:
+    using SIMDSample = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int channelsPerGroup = static_cast<int>(SIMDSample::SIMDNumElements);
+    static_assert(channelsPerGroup >= 2, "The two paths need a lane each");
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    // Audio thread. Copies the coefficients; allocation free. Path B is
+    // ignored while the StereoMode is StereoLinked.
+    void setCoefficients(const PathCoefficients& coefficients) noexcept;
+    void setStereoMode(StereoMode newStereoMode) noexcept;
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    enum
+    {
+        firstLowCutSection = 0,
+        firstBandSection = 4,
+        firstHighCutSection = firstBandSection + maxBands,
+        maxSections = firstHighCutSection + 4
+    };
+
+    struct Section
+    {
+        SIMDSample b0, b1, b2, a1, a2;
+    };
+
+    struct State
+    {
+        SIMDSample z1, z2;
+    };
+
+    using GroupStates = std::array<State, maxSections>;
+    using SectionArray = std::array<Section, maxSections>;
+
+    static constexpr int maxCascadeLength = 4;
+
+    // Runs the sections at `indices` one after the other over every sample.
+    using CascadeFunction = void (*)(const SectionArray& sections,
+                                     GroupStates& states,
+                                     const int* indices,
+                                     SIMDSample* samples,
+                                     int numSamples) noexcept;
+
+    struct Cascade
+    {
+        CascadeFunction process;
+        int firstActiveSection;
+    };
+
+    template <size_t... SectionIndex>
+    static void processCascade(const SectionArray& sections,
+                               GroupStates& states,
+                               const int* indices,
+                               SIMDSample* samples,
+                               int numSamples,
+                               std::index_sequence<SectionIndex...>) noexcept;
+
+    template <int length>
+    static void processCascade(const SectionArray& sections,
+                               GroupStates& states,
+                               const int* indices,
+                               SIMDSample* samples,
+                               int numSamples) noexcept;
+
+    static Section makeSection(const BiquadCoefficients& coefficients) noexcept;
+    static Section makeSection(const BiquadCoefficients& pathA, const BiquadCoefficients& pathB) noexcept;
+
+    void updateSections() noexcept;
+
+    void interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) noexcept;
+    void deinterleave(juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) const noexcept;
+
+    PathCoefficients pathCoefficients;
+    StereoMode stereoMode{ StereoLinked };
+
+    // frontSections run the first group, sections every other one.
+    SectionArray sections, frontSections;
+    std::vector<GroupStates> groupStates;
+
+    std::array<int, maxSections> activeSections{};
+    int numActiveSections{ 0 };
+
+    std::array<Cascade, maxSections> cascades{};
+    int numCascades{ 0 };
+
+    std::vector<SIMDSample> interleaved;
+};
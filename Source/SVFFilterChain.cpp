@@ -0,0 +1,476 @@
+/*
+  ==============================================================================
+
+    SVFFilterChain.cpp
+    Topology-preserving transform (state variable) version of the
+    LowCut -> bands -> HighCut cascade.
+
+  ==============================================================================
+*/
+
+#include "SVFFilterChain.h"
+
+namespace
+{
+    template <typename SampleType>
+    SampleType prewarpedCutoff(double sampleRate, float frequency) noexcept
+    {
+        auto nyquistSafe = juce::jmin(static_cast<double>(frequency), sampleRate * 0.49);
+        return static_cast<SampleType>(std::tan(juce::MathConstants<double>::pi * nyquistSafe / sampleRate));
+    }
+
+    // Same section Qs as the biquad Butterworth designs.
+    double butterworthSectionQuality(int section, int order) noexcept
+    {
+        return 1.0 / (2.0 * std::cos((2.0 * section + 1.0) * juce::MathConstants<double>::pi / (order * 2.0)));
+    }
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::prepare(const juce::dsp::ProcessSpec& spec)
+{
+    auto numGroups = (static_cast<size_t>(spec.numChannels) + channelsPerGroup - 1) / channelsPerGroup;
+
+    sampleRate = spec.sampleRate;
+    groupStates.resize(juce::jmax(static_cast<size_t>(1), numGroups));
+    interleaved.assign(spec.maximumBlockSize, SIMDSample::expand(SampleType(0)));
+
+    for (auto& section : sections)
+        for (auto& ramp : section.paths)
+        {
+            ramp.current = ramp.target = {};
+            ramp.increment = { 0, 0, 0, 0, 0 };
+            ramp.samplesRemaining = 0;
+        }
+
+    pathBLane = SIMDSample::expand(SampleType(0));
+    pathBLane.set(1, SampleType(1));
+
+    numLowCutSections.fill(0);
+    numHighCutSections.fill(0);
+    for (auto& filterTypes : bandFilterTypes)
+        filterTypes.fill(-1);
+    numActiveSections = 0;
+
+    reset();
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::reset() noexcept
+{
+    for (auto& states : groupStates)
+        for (auto& state : states)
+            state.ic1eq = state.ic2eq = SIMDSample::expand(SampleType(0));
+}
+
+template <typename SampleType>
+typename SVFFilterChain<SampleType>::Parameters SVFFilterChain<SampleType>::makeHighPass(SampleType g, double quality) noexcept
+{
+    auto k = static_cast<SampleType>(1.0 / quality);
+    return { g, k, SampleType(1), -k, SampleType(-1) };
+}
+
+template <typename SampleType>
+typename SVFFilterChain<SampleType>::Parameters SVFFilterChain<SampleType>::makeLowPass(SampleType g, double quality) noexcept
+{
+    auto k = static_cast<SampleType>(1.0 / quality);
+    return { g, k, SampleType(0), SampleType(0), SampleType(1) };
+}
+
+template <typename SampleType>
+typename SVFFilterChain<SampleType>::Parameters SVFFilterChain<SampleType>::makeBand(const ChainSettings& chainSettings, int band, double sampleRate) noexcept
+{
+    auto g = prewarpedCutoff<SampleType>(sampleRate, juce::jmax(chainSettings.peakFreq[band], 2.f));
+    auto k = SampleType(1) / static_cast<SampleType>(chainSettings.peakQuality[band]);
+    auto one = SampleType(1), zero = SampleType(0);
+
+    switch (chainSettings.filterName[band])
+    {
+    case PeakFilter:
+    {
+        // Bell with the same analog prototype as the RBJ peak filter:
+        // (s^2 + s A / Q + 1) / (s^2 + s / (A Q) + 1)
+        auto A = std::pow(SampleType(10), static_cast<SampleType>(chainSettings.peakGainInDecibels[band]) / SampleType(40));
+        auto bellK = k / A;
+        return { g, bellK, one, bellK * (A * A - one), zero };
+    }
+    case NotchFilter:
+        return { g, k, one, -k, zero };
+    case BandPassFilter:
+        return { g, k, zero, k, zero };
+    default:
+        jassertfalse; // Invalid filter type
+        return { g, k, one, zero, zero };
+    }
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::setTarget(int sectionIndex, int path, const Parameters& target, int rampLengthInSamples) noexcept
+{
+    auto& ramp = sections[sectionIndex].paths[path];
+    ramp.target = target;
+
+    if (rampLengthInSamples <= 0)
+    {
+        ramp.current = target;
+        ramp.samplesRemaining = 0;
+        return;
+    }
+
+    auto scale = SampleType(1) / static_cast<SampleType>(rampLengthInSamples);
+
+    ramp.increment = { (target.g - ramp.current.g) * scale,
+                       (target.k - ramp.current.k) * scale,
+                       (target.m0 - ramp.current.m0) * scale,
+                       (target.m1 - ramp.current.m1) * scale,
+                       (target.m2 - ramp.current.m2) * scale };
+
+    ramp.samplesRemaining = rampLengthInSamples;
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::setParameters(const ChainSettings& chainSettings, int rampLengthInSamples, int path) noexcept
+{
+    // Sections that were inactive, or a band after a change of filter type,
+    // have no meaningful current value to ramp from.
+    auto rampFor = [rampLengthInSamples](bool wasActive) { return wasActive ? rampLengthInSamples : 0; };
+
+    // Sections this path doesn't use pass its lane through, in case the
+    // other path needs them.
+    auto lowCutSections = juce::jlimit(1, 4, chainSettings.lowCutSlope + 1);
+    auto lowCutG = prewarpedCutoff<SampleType>(sampleRate, chainSettings.lowCutFreq);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i < lowCutSections)
+            setTarget(firstLowCutSection + i, path, makeHighPass(lowCutG, butterworthSectionQuality(i, 2 * lowCutSections)),
+                      rampFor(i < numLowCutSections[path]));
+        else
+            setTarget(firstLowCutSection + i, path, {}, 0);
+    }
+
+    auto& filterTypes = bandFilterTypes[path];
+
+    for (int band = 0; band < maxBands; ++band)
+    {
+        if (chainSettings.bandEnabled[band])
+        {
+            setTarget(firstBandSection + band, path, makeBand(chainSettings, band, sampleRate),
+                      rampFor(chainSettings.filterName[band] == filterTypes[band]));
+            filterTypes[band] = chainSettings.filterName[band];
+        }
+        else if (filterTypes[band] >= 0)
+        {
+            setTarget(firstBandSection + band, path, {}, 0);
+            filterTypes[band] = -1;
+        }
+    }
+
+    auto highCutSections = juce::jlimit(1, 4, chainSettings.highCutSlope + 1);
+    auto highCutG = prewarpedCutoff<SampleType>(sampleRate, chainSettings.highCutFreq);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        if (i < highCutSections)
+            setTarget(firstHighCutSection + i, path, makeLowPass(highCutG, butterworthSectionQuality(i, 2 * highCutSections)),
+                      rampFor(i < numHighCutSections[path]));
+        else
+            setTarget(firstHighCutSection + i, path, {}, 0);
+    }
+
+    numLowCutSections[path] = lowCutSections;
+    numHighCutSections[path] = highCutSections;
+
+    updateActiveSections();
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::setStereoMode(StereoMode newStereoMode) noexcept
+{
+    stereoMode = newStereoMode;
+    updateActiveSections();
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::updateActiveSections() noexcept
+{
+    auto split = stereoMode != StereoLinked;
+    auto numLowCut = split ? juce::jmax(numLowCutSections[PathA], numLowCutSections[PathB]) : numLowCutSections[PathA];
+    auto numHighCut = split ? juce::jmax(numHighCutSections[PathA], numHighCutSections[PathB]) : numHighCutSections[PathA];
+
+    numActiveSections = 0;
+
+    for (int i = 0; i < numLowCut; ++i)
+        activeSections[numActiveSections++] = firstLowCutSection + i;
+
+    for (int band = 0; band < maxBands; ++band)
+        if (bandFilterTypes[PathA][band] >= 0 || (split && bandFilterTypes[PathB][band] >= 0))
+            activeSections[numActiveSections++] = firstBandSection + band;
+
+    for (int i = 0; i < numHighCut; ++i)
+        activeSections[numActiveSections++] = firstHighCutSection + i;
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept
+{
+    auto& block = context.getOutputBlock();
+    auto numChannels = block.getNumChannels();
+    auto numSamples = static_cast<int>(block.getNumSamples());
+
+    jassert(numChannels <= groupStates.size() * channelsPerGroup);
+    jassert(numSamples <= static_cast<int>(interleaved.size()));
+
+    if (context.isBypassed || numSamples == 0)
+        return;
+
+    for (size_t group = 0; group * channelsPerGroup < numChannels; ++group)
+    {
+        auto firstChannel = group * channelsPerGroup;
+        auto& states = groupStates[group];
+        auto split = group == 0 && stereoMode != StereoLinked;
+
+        interleave(block, firstChannel);
+
+        for (int i = 0; i < numActiveSections; ++i)
+        {
+            if (split)
+                processSplitSection(sections[activeSections[i]], states[activeSections[i]], numSamples);
+            else
+                processSection(sections[activeSections[i]], states[activeSections[i]], numSamples);
+        }
+
+        deinterleave(block, firstChannel);
+    }
+
+    for (int i = 0; i < numActiveSections; ++i)
+        advanceRamps(sections[activeSections[i]], numSamples);
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) noexcept
+{
+    auto* lanes = reinterpret_cast<SampleType*>(interleaved.data());
+    auto numChannels = juce::jmin(block.getNumChannels() - firstChannel, static_cast<size_t>(channelsPerGroup));
+    auto numSamples = block.getNumSamples();
+    size_t channel = 0;
+
+    if (firstChannel == 0 && numChannels >= 2 && stereoMode == MidSide)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            lanes[i * channelsPerGroup] = SampleType(0.5) * (left[i] + right[i]);
+            lanes[i * channelsPerGroup + 1] = SampleType(0.5) * (left[i] - right[i]);
+        }
+
+        channel = 2;
+    }
+
+    for (; channel < numChannels; ++channel)
+    {
+        auto* source = block.getChannelPointer(firstChannel + channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            lanes[i * channelsPerGroup + channel] = source[i];
+    }
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::deinterleave(juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) const noexcept
+{
+    auto* lanes = reinterpret_cast<const SampleType*>(interleaved.data());
+    auto numChannels = juce::jmin(block.getNumChannels() - firstChannel, static_cast<size_t>(channelsPerGroup));
+    auto numSamples = block.getNumSamples();
+    size_t channel = 0;
+
+    if (firstChannel == 0 && numChannels >= 2 && stereoMode == MidSide)
+    {
+        auto* left = block.getChannelPointer(0);
+        auto* right = block.getChannelPointer(1);
+
+        for (size_t i = 0; i < numSamples; ++i)
+        {
+            auto mid = lanes[i * channelsPerGroup];
+            auto side = lanes[i * channelsPerGroup + 1];
+
+            left[i] = mid + side;
+            right[i] = mid - side;
+        }
+
+        channel = 2;
+    }
+
+    for (; channel < numChannels; ++channel)
+    {
+        auto* destination = block.getChannelPointer(firstChannel + channel);
+
+        for (size_t i = 0; i < numSamples; ++i)
+            destination[i] = lanes[i * channelsPerGroup + channel];
+    }
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::stepRamp(Parameters& p, int& samplesRemaining, const Ramp& ramp) noexcept
+{
+    if (samplesRemaining <= 0)
+        return;
+
+    if (--samplesRemaining == 0)
+    {
+        p = ramp.target;
+    }
+    else
+    {
+        const auto& d = ramp.increment;
+
+        p.g += d.g;
+        p.k += d.k;
+        p.m0 += d.m0;
+        p.m1 += d.m1;
+        p.m2 += d.m2;
+    }
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::advanceRamps(Section& section, int numSamples) noexcept
+{
+    // Exactly the steps processSection() took, so the next block carries on
+    // from the coefficients the last sample used.
+    for (auto& ramp : section.paths)
+        for (int i = 0; i < numSamples && ramp.samplesRemaining > 0; ++i)
+            stepRamp(ramp.current, ramp.samplesRemaining, ramp);
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::processSection(const Section& section, State& state, int numSamples) noexcept
+{
+    auto* samples = interleaved.data();
+    auto ic1eq = state.ic1eq, ic2eq = state.ic2eq;
+
+    auto tick = [&](const Parameters& p, int i)
+    {
+        // a1 = 1 / (1 + g (g + k)), a2 = g a1, a3 = g a2
+        auto a1 = SampleType(1) / (SampleType(1) + p.g * (p.g + p.k));
+        auto a2 = p.g * a1;
+        auto a3 = p.g * a2;
+
+        auto v0 = samples[i];
+        auto v3 = v0 - ic2eq;
+        auto v1 = ic1eq * a1 + v3 * a2;
+        auto v2 = ic2eq + ic1eq * a2 + v3 * a3;
+
+        ic1eq = v1 * SampleType(2) - ic1eq;
+        ic2eq = v2 * SampleType(2) - ic2eq;
+
+        samples[i] = v0 * p.m0 + v1 * p.m1 + v2 * p.m2;
+    };
+
+    int i = 0;
+
+    // Ramp: one scalar division per sample per section, shared by all lanes.
+    const auto& ramp = section.paths[PathA];
+    auto p = ramp.current;
+    auto rampSamplesRemaining = ramp.samplesRemaining;
+
+    for (; i < numSamples && rampSamplesRemaining > 0; ++i)
+    {
+        stepRamp(p, rampSamplesRemaining, ramp);
+        tick(p, i);
+    }
+
+    // Steady state: hoist the coefficients out of the loop.
+    if (i < numSamples)
+    {
+        auto a1 = SampleType(1) / (SampleType(1) + p.g * (p.g + p.k));
+        auto a2 = SIMDSample::expand(p.g * a1);
+        auto a3 = SIMDSample::expand(p.g * p.g * a1);
+        auto a1v = SIMDSample::expand(a1);
+        auto m0 = SIMDSample::expand(p.m0), m1 = SIMDSample::expand(p.m1), m2 = SIMDSample::expand(p.m2);
+        auto two = SIMDSample::expand(SampleType(2));
+
+        for (; i < numSamples; ++i)
+        {
+            auto v0 = samples[i];
+            auto v3 = v0 - ic2eq;
+            auto v1 = a1v * ic1eq + a2 * v3;
+            auto v2 = ic2eq + a2 * ic1eq + a3 * v3;
+
+            ic1eq = two * v1 - ic1eq;
+            ic2eq = two * v2 - ic2eq;
+
+            samples[i] = m0 * v0 + m1 * v1 + m2 * v2;
+        }
+    }
+
+    state.ic1eq = ic1eq;
+    state.ic2eq = ic2eq;
+}
+
+template <typename SampleType>
+typename SVFFilterChain<SampleType>::LaneCoefficients SVFFilterChain<SampleType>::makeLaneCoefficients(const Parameters& pathA, const Parameters& pathB) const noexcept
+{
+    auto a1A = SampleType(1) / (SampleType(1) + pathA.g * (pathA.g + pathA.k));
+    auto a1B = SampleType(1) / (SampleType(1) + pathB.g * (pathB.g + pathB.k));
+
+    auto blend = [this](SampleType a, SampleType b) { return SIMDSample::expand(a) + pathBLane * (b - a); };
+
+    return { blend(a1A, a1B),
+             blend(pathA.g * a1A, pathB.g * a1B),
+             blend(pathA.g * pathA.g * a1A, pathB.g * pathB.g * a1B),
+             blend(pathA.m0, pathB.m0),
+             blend(pathA.m1, pathB.m1),
+             blend(pathA.m2, pathB.m2) };
+}
+
+template <typename SampleType>
+void SVFFilterChain<SampleType>::processSplitSection(const Section& section, State& state, int numSamples) noexcept
+{
+    auto* samples = interleaved.data();
+    auto ic1eq = state.ic1eq, ic2eq = state.ic2eq;
+    auto two = SIMDSample::expand(SampleType(2));
+
+    auto tick = [&](const LaneCoefficients& c, int i)
+    {
+        auto v0 = samples[i];
+        auto v3 = v0 - ic2eq;
+        auto v1 = c.a1 * ic1eq + c.a2 * v3;
+        auto v2 = ic2eq + c.a2 * ic1eq + c.a3 * v3;
+
+        ic1eq = two * v1 - ic1eq;
+        ic2eq = two * v2 - ic2eq;
+
+        samples[i] = c.m0 * v0 + c.m1 * v1 + c.m2 * v2;
+    };
+
+    int i = 0;
+
+    // Ramp until both paths have arrived: two scalar divisions per sample.
+    const auto& rampA = section.paths[PathA];
+    const auto& rampB = section.paths[PathB];
+    auto pA = rampA.current, pB = rampB.current;
+    auto remainingA = rampA.samplesRemaining, remainingB = rampB.samplesRemaining;
+
+    for (; i < numSamples && (remainingA > 0 || remainingB > 0); ++i)
+    {
+        stepRamp(pA, remainingA, rampA);
+        stepRamp(pB, remainingB, rampB);
+        tick(makeLaneCoefficients(pA, pB), i);
+    }
+
+    if (i < numSamples)
+    {
+        auto coefficients = makeLaneCoefficients(pA, pB);
+
+        for (; i < numSamples; ++i)
+            tick(coefficients, i);
+    }
+
+    state.ic1eq = ic1eq;
+    state.ic2eq = ic2eq;
+}
+
+template class SVFFilterChain<float>;
+template class SVFFilterChain<double>;
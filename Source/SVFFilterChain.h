@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    SVFFilterChain.h
+    Topology-preserving transform (state variable) version of the
+    LowCut -> bands -> HighCut cascade.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    Alternative to SIMDFilterChain built from trapezoidal-integrated state
+    variable filters (Zavalishin / Simper). Each section is described by the
+    prewarped cutoff g = tan(pi * fc / fs), the damping k = 1 / Q and three
+    output mix gains, so a parameter change costs one tan and a few multiplies
+    rather than a full redesign.
+
+    Because the structure stays stable however fast g and k move, new
+    parameters are approached with a per-sample linear ramp of g, k and the
+    mix gains. This gives sample-smooth modulation while the tan is only
+    evaluated once per call to setParameters().
+
+    In steady state every stage has exactly the same (bilinear, prewarped)
+    magnitude response as the corresponding biquad design.
+
+    Channels run in groups of SIMD lanes, as in SIMDFilterChain. The ramps
+    are shared: every group follows the same coefficient trajectory. Each
+    section ramps the two paths separately; path B only reaches lane 1 of
+    the first group, and only while the StereoMode splits the channels.
+
+    Instantiated for float and double; the ramps and coefficients use the
+    same type as the samples.
+*/
+template <typename SampleType>
+class SVFFilterChain
+{
+public:
+    using SIMDSample = juce::dsp::SIMDRegister<SampleType>;
+
+    static constexpr int channelsPerGroup = static_cast<int>(SIMDSample::SIMDNumElements);
+    static_assert(channelsPerGroup >= 2, "The two paths need a lane each");
+
+    void prepare(const juce::dsp::ProcessSpec& spec);
+    void reset() noexcept;
+
+    // Audio thread. Moves every stage towards `chainSettings` over the next
+    // `rampLengthInSamples` samples, or jumps straight there if it is 0. Slope
+    // and filter type changes always take effect immediately.
+    void setParameters(const ChainSettings& chainSettings, int rampLengthInSamples, int path = PathA) noexcept;
+    void setStereoMode(StereoMode newStereoMode) noexcept;
+
+    void process(const juce::dsp::ProcessContextReplacing<SampleType>& context) noexcept;
+
+private:
+    enum
+    {
+        firstLowCutSection = 0,
+        firstBandSection = 4,
+        firstHighCutSection = firstBandSection + maxBands,
+        maxSections = firstHighCutSection + 4
+    };
+
+    // The defaults pass the input straight through.
+    struct Parameters
+    {
+        SampleType g{ 0 }, k{ 2 }, m0{ 1 }, m1{ 0 }, m2{ 0 };
+    };
+
+    struct Ramp
+    {
+        Parameters current, target, increment;
+        int samplesRemaining{ 0 };
+    };
+
+    struct Section
+    {
+        std::array<Ramp, numChainPaths> paths;
+    };
+
+    // Per-lane coefficients for the first group while the paths are split.
+    struct LaneCoefficients
+    {
+        SIMDSample a1, a2, a3, m0, m1, m2;
+    };
+
+    struct State
+    {
+        SIMDSample ic1eq, ic2eq;
+    };
+
+    using GroupStates = std::array<State, maxSections>;
+
+    static Parameters makeHighPass(SampleType g, double quality) noexcept;
+    static Parameters makeLowPass(SampleType g, double quality) noexcept;
+    static Parameters makeBand(const ChainSettings& chainSettings, int band, double sampleRate) noexcept;
+
+    void setTarget(int sectionIndex, int path, const Parameters& target, int rampLengthInSamples) noexcept;
+    void updateActiveSections() noexcept;
+
+    // One sample of a ramp; does nothing once the ramp has finished.
+    static void stepRamp(Parameters& parameters, int& samplesRemaining, const Ramp& ramp) noexcept;
+    LaneCoefficients makeLaneCoefficients(const Parameters& pathA, const Parameters& pathB) const noexcept;
+
+    void interleave(const juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) noexcept;
+    void deinterleave(juce::dsp::AudioBlock<SampleType>& block, size_t firstChannel) const noexcept;
+
+    // Runs one group through a section without touching the section's ramp,
+    // so every group starts from the same point; advanceRamp() then moves
+    // the ramp on once for all of them.
+    void processSection(const Section& section, State& state, int numSamples) noexcept;
+    void processSplitSection(const Section& section, State& state, int numSamples) noexcept;
+    static void advanceRamps(Section& section, int numSamples) noexcept;
+
+    double sampleRate{ 44100.0 };
+
+    std::array<Section, maxSections> sections;
+    std::vector<GroupStates> groupStates;
+
+    std::array<int, maxSections> activeSections{};
+    int numActiveSections{ 0 };
+
+    StereoMode stereoMode{ StereoLinked };
+
+    // 1 in lane 1, 0 elsewhere: blends path B into the first group.
+    SIMDSample pathBLane;
+
+    // What setParameters() last activated for each path, to tell ramps
+    // from jumps.
+    std::array<int, numChainPaths> numLowCutSections{}, numHighCutSections{};
+    // Filter type of each band, or -1 while it is disabled.
+    std::array<std::array<int, maxBands>, numChainPaths> bandFilterTypes{};
+
+    std::vector<SIMDSample> interleaved;
+};
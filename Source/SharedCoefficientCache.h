@@ -0,0 +1,264 @@
+/*
+  ==============================================================================
+
+    SharedCoefficientCache.h
+    Process-wide filter designs, shared by every plugin instance's
+    coefficient designer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "FilterDesign.h"
+
+/**
+    Fixed size hash table of reference counted designs keyed by
+    (sample rate, design key), safe to use from any number of threads
+    without locks.
+
+    Each slot holds its design inline, with one atomic word for its state
+    and reference count, so no entry is ever freed and no reclamation scheme
+    is needed. findOrDesign() hands out a Reference, which keeps the design
+    from changing for as long as it is held. A design nobody references
+    stays cached, so automation sweeping back over it still finds it, until
+    its slot is needed for another:
+    - Lookups compare the keys along a linear probe and only take a
+      reference on a match.
+    - A missing design claims an empty slot while the table is less than
+      maxLoad full, or else recycles an unreferenced slot on its probe, in
+      place, so probe chains are never broken.
+    - Claims are compare-and-swaps. Two threads racing for the same key may
+      each add a copy; both are valid, and the spare is recycled once unused.
+
+    When every slot on the probe is referenced, findOrDesign() returns a
+    null Reference and the caller designs without caching.
+*/
+template<typename ValueType>
+class SharedDesignTable
+{
+    struct Slot;
+
+public:
+    explicit SharedDesignTable(int capacityLog2)
+        : slots(size_t(1) << capacityLog2),
+          mask(slots.size() - 1),
+          maxEntries(slots.size() / 4 * 3)
+    {
+    }
+
+    ~SharedDesignTable()
+    {
+        jassert(std::none_of(slots.begin(), slots.end(), [](const Slot& slot) { return getReferenceCount(slot.state.load()) != 0; }));
+    }
+
+    // One reference on a design. Moving it passes the reference on;
+    // destroying or reassigning it drops it.
+    class Reference
+    {
+    public:
+        Reference() = default;
+        Reference(Reference&& other) noexcept : slot(std::exchange(other.slot, nullptr)) {}
+
+        Reference& operator=(Reference&& other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                slot = std::exchange(other.slot, nullptr);
+            }
+
+            return *this;
+        }
+
+        ~Reference() { reset(); }
+
+        void reset() noexcept
+        {
+            if (slot != nullptr)
+                std::exchange(slot, nullptr)->state.fetch_sub(1, std::memory_order_release);
+        }
+
+        explicit operator bool() const noexcept { return slot != nullptr; }
+        const ValueType& operator*() const noexcept { return slot->value; }
+
+    private:
+        friend class SharedDesignTable;
+        explicit Reference(Slot& s) noexcept : slot(&s) {}
+
+        Slot* slot{ nullptr };
+
+        JUCE_DECLARE_NON_COPYABLE(Reference)
+    };
+
+    // Returns a reference on the design for (sampleRate, key), calling
+    // `designFunction` to make it if no instance has yet. Returns a null
+    // Reference if there is no room for it.
+    template<typename DesignFunction>
+    Reference findOrDesign(double sampleRate, juce::uint64 key, DesignFunction&& designFunction)
+    {
+        auto hash = getHash(sampleRate, key);
+
+        // A claim only fails if another thread changed that slot since it
+        // was looked at, so a few attempts are plenty.
+        for (int attempt = 0; attempt < maxAttempts; ++attempt)
+        {
+            Slot* empty = nullptr;
+            Slot* unreferenced = nullptr;
+
+            for (size_t probe = 0; probe < maxProbe; ++probe)
+            {
+                auto& slot = slots[(hash + probe) & mask];
+                auto state = slot.state.load(std::memory_order_acquire);
+
+                // Slots are never emptied, so no chain goes past an empty one.
+                if (getStatus(state) == Empty)
+                {
+                    empty = &slot;
+                    break;
+                }
+
+                if (getStatus(state) != Ready)
+                    continue;
+
+                if (slot.key.load(std::memory_order_relaxed) == key
+                    && slot.sampleRate.load(std::memory_order_relaxed) == sampleRate
+                    && tryAcquire(slot))
+                {
+                    // Held now, so the key can no longer change under it.
+                    if (slot.key.load(std::memory_order_relaxed) == key
+                        && slot.sampleRate.load(std::memory_order_relaxed) == sampleRate)
+                        return Reference(slot);
+
+                    slot.state.fetch_sub(1, std::memory_order_release);
+                }
+
+                if (unreferenced == nullptr && getReferenceCount(state) == 0)
+                    unreferenced = &slot;
+            }
+
+            if (empty != nullptr && numEntries.load(std::memory_order_relaxed) < maxEntries)
+            {
+                auto expected = packState(Empty, 0);
+
+                if (empty->state.compare_exchange_strong(expected, packState(Designing, 0), std::memory_order_acquire))
+                {
+                    numEntries.fetch_add(1, std::memory_order_relaxed);
+                    return publish(*empty, sampleRate, key, designFunction);
+                }
+            }
+            else if (unreferenced != nullptr)
+            {
+                auto expected = packState(Ready, 0);
+
+                if (unreferenced->state.compare_exchange_strong(expected, packState(Designing, 0), std::memory_order_acquire))
+                    return publish(*unreferenced, sampleRate, key, designFunction);
+            }
+            else
+            {
+                return {};
+            }
+        }
+
+        return {};
+    }
+
+    size_t getNumEntries() const noexcept { return numEntries.load(std::memory_order_relaxed); }
+
+private:
+    // The state word: the status in the upper half, the number of
+    // References held in the lower.
+    enum Status : juce::uint64
+    {
+        Empty,
+        Designing,
+        Ready
+    };
+
+    struct Slot
+    {
+        std::atomic<juce::uint64> state{ 0 };
+
+        // Only written while Designing. Atomic so lookups can compare them
+        // without holding a reference.
+        std::atomic<juce::uint64> key{ 0 };
+        std::atomic<double> sampleRate{ 0.0 };
+
+        ValueType value{};
+    };
+
+    static constexpr size_t maxProbe = 32;
+    static constexpr int maxAttempts = 4;
+
+    static constexpr juce::uint64 packState(Status status, juce::uint64 referenceCount) noexcept
+    {
+        return (static_cast<juce::uint64>(status) << 32) | referenceCount;
+    }
+
+    static constexpr Status getStatus(juce::uint64 state) noexcept { return static_cast<Status>(state >> 32); }
+    static constexpr juce::uint64 getReferenceCount(juce::uint64 state) noexcept { return state & 0xffffffffull; }
+
+    static bool tryAcquire(Slot& slot) noexcept
+    {
+        auto state = slot.state.load(std::memory_order_acquire);
+
+        while (getStatus(state) == Ready)
+            if (slot.state.compare_exchange_weak(state, state + 1, std::memory_order_acquire))
+                return true;
+
+        return false;
+    }
+
+    template<typename DesignFunction>
+    static Reference publish(Slot& slot, double sampleRate, juce::uint64 key, DesignFunction& designFunction)
+    {
+        slot.key.store(key, std::memory_order_relaxed);
+        slot.sampleRate.store(sampleRate, std::memory_order_relaxed);
+        slot.value = designFunction();
+        slot.state.store(packState(Ready, 1), std::memory_order_release);
+
+        return Reference(slot);
+    }
+
+    static size_t getHash(double sampleRate, juce::uint64 key) noexcept
+    {
+        juce::uint64 rateBits;
+        std::memcpy(&rateBits, &sampleRate, sizeof(rateBits));
+
+        // splitmix64's finaliser: the keys are packed bit fields, so nearby
+        // settings differ in only a few bits.
+        auto hash = key ^ (rateBits * 0x9e3779b97f4a7c15ull);
+        hash = (hash ^ (hash >> 30)) * 0xbf58476d1ce4e5b9ull;
+        hash = (hash ^ (hash >> 27)) * 0x94d049bb133111ebull;
+
+        return static_cast<size_t>(hash ^ (hash >> 31));
+    }
+
+    std::vector<Slot> slots;
+    const size_t mask, maxEntries;
+    std::atomic<size_t> numEntries{ 0 };
+
+    JUCE_DECLARE_NON_COPYABLE(SharedDesignTable)
+};
+
+/**
+    The designs every Project_EEAVAudioProcessor in the process shares, so
+    a session full of instances on the same settings designs each filter
+    once and keeps one copy of it. Held through a
+    juce::SharedResourcePointer: created with the first instance and
+    destroyed with the last.
+
+    Each instance references the designs its paths are using, so those
+    stay put; the rest are recycled as new settings need room. Sized for
+    about a hundred instances with every band in use on both paths.
+
+    The keys are CoefficientCache's parameter bins, so they are only
+    meaningful to it.
+*/
+struct SharedCoefficientCache
+{
+    SharedDesignTable<CutCoefficients> lowCuts{ 12 }, highCuts{ 12 };
+    SharedDesignTable<BiquadCoefficients> bands{ 13 };
+};
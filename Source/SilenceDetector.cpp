@@ -0,0 +1,44 @@
+/*
+  ==============================================================================
+
+    SilenceDetector.cpp
+    Decides when the filters can be skipped because the input is silent and
+    whatever was ringing has died away.
+
+  ==============================================================================
+*/
+
+#include "SilenceDetector.h"
+
+void SilenceDetector::reset() noexcept
+{
+    silentSamples = 0;
+    ringDownSamples = 0;
+    skipping = false;
+}
+
+SilenceDetector::BlockAction SilenceDetector::advance(bool inputIsSilent, int numSamples) noexcept
+{
+    if (!inputIsSilent)
+    {
+        silentSamples = 0;
+        skipping = false;
+        return Process;
+    }
+
+    // Counted from the start of the block: the filters ring from the last
+    // non-silent sample, which was in an earlier block.
+    auto rungDown = silentSamples >= ringDownSamples;
+
+    // Saturates rather than wrapping in sessions that stay silent for hours.
+    silentSamples = juce::jmin(silentSamples, std::numeric_limits<int>::max() - numSamples) + numSamples;
+
+    if (!rungDown)
+        return Process;
+
+    if (skipping)
+        return Skip;
+
+    skipping = true;
+    return Flush;
+}
@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    SilenceDetector.h
+    Decides when the filters can be skipped because the input is silent and
+    whatever was ringing has died away.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Counts how long the input has stayed below silenceThreshold (-120 dB).
+    Once that is longer than the filters take to ring down to the same
+    level, processing them changes nothing audible, so the processor can
+    clear the block instead. The first skipped block is reported as Flush so
+    the filter state can be cleared once; any input above the threshold
+    resumes processing from clean state.
+
+    The ring down time is only asked for when a silence starts, so skipped
+    blocks cost one peak scan of the input and nothing else.
+
+    Audio thread only.
+*/
+class SilenceDetector
+{
+public:
+    static constexpr double silenceThreshold = 1.0e-6; // -120 dB
+
+    enum BlockAction
+    {
+        Process,
+        Flush, // Skip this block, clearing the filter state first
+        Skip
+    };
+
+    void reset() noexcept;
+
+    template <typename SampleType>
+    static bool isSilent(const juce::dsp::AudioBlock<SampleType>& block) noexcept
+    {
+        using ValueType = std::remove_const_t<SampleType>;
+        auto range = block.findMinAndMax();
+
+        return juce::jmax(-range.getStart(), range.getEnd()) <= static_cast<ValueType>(silenceThreshold);
+    }
+
+    // True when this block starts a silence, i.e. when setRingDownSamples()
+    // should be called before advance().
+    bool isSilenceStarting(bool inputIsSilent) const noexcept { return inputIsSilent && silentSamples == 0; }
+    void setRingDownSamples(int numSamples) noexcept { ringDownSamples = juce::jmax(0, numSamples); }
+
+    // Call once per block, before processing it.
+    BlockAction advance(bool inputIsSilent, int numSamples) noexcept;
+
+    bool isSkipping() const noexcept { return skipping; }
+
+private:
+    int silentSamples{ 0 };
+    int ringDownSamples{ 0 };
+    bool skipping{ false };
+};
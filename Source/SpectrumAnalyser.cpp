@@ -0,0 +1,120 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.cpp
+    Message thread side of the spectrum analyser: windowed FFT of the samples
+    arriving through an AnalyserFifo, smoothed and reduced to one value per
+    pixel.
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyser.h"
+
+SpectrumAnalyser::SpectrumAnalyser(AnalyserFifo& source)
+    : fifo(source),
+      history(static_cast<size_t>(fftSize), 0.f),
+      incoming(static_cast<size_t>(AnalyserFifo::capacity), 0.f),
+      fftData(static_cast<size_t>(2 * fftSize), 0.f),
+      levels(static_cast<size_t>(numBins), floorDecibels)
+{
+}
+
+bool SpectrumAnalyser::process()
+{
+    auto numPulled = fifo.pull(incoming.data(), static_cast<int>(incoming.size()));
+
+    for (int i = 0; i < numPulled; ++i)
+    {
+        history[static_cast<size_t>(historyPosition)] = incoming[static_cast<size_t>(i)];
+        historyPosition = (historyPosition + 1) % fftSize;
+    }
+
+    samplesSinceLastTransform += numPulled;
+
+    if (samplesSinceLastTransform < hopSize)
+        return false;
+
+    samplesSinceLastTransform = 0;
+
+    // Unroll the ring so the oldest sample comes first.
+    auto tail = static_cast<size_t>(fftSize - historyPosition);
+    std::copy(history.begin() + historyPosition, history.end(), fftData.begin());
+    std::copy(history.begin(), history.begin() + historyPosition, fftData.begin() + static_cast<std::ptrdiff_t>(tail));
+    std::fill(fftData.begin() + fftSize, fftData.end(), 0.f);
+
+    window.multiplyWithWindowingTable(fftData.data(), static_cast<size_t>(fftSize));
+    fft.performFrequencyOnlyForwardTransform(fftData.data(), true);
+
+    // A full scale sine reads 0 dB: 2 / N for the one-sided spectrum, and
+    // another factor 2 for the Hann window's coherent gain of 0.5.
+    constexpr float normalisation = 4.f / static_cast<float>(fftSize);
+
+    for (int bin = 0; bin < numBins; ++bin)
+    {
+        auto level = juce::Decibels::gainToDecibels(fftData[static_cast<size_t>(bin)] * normalisation, floorDecibels);
+        auto& smoothed = levels[static_cast<size_t>(bin)];
+
+        // Instant attack, smoothed release.
+        smoothed = level > smoothed ? level : smoothed + (level - smoothed) * releaseCoefficient;
+    }
+
+    return true;
+}
+
+void SpectrumAnalyser::updatePixelBins(int width, double sampleRate)
+{
+    if (static_cast<int>(pixelBins.size()) == width && pixelBinsSampleRate == sampleRate)
+        return;
+
+    pixelBins.resize(static_cast<size_t>(width));
+    pixelBinsSampleRate = sampleRate;
+
+    auto binWidth = sampleRate / fftSize;
+
+    auto frequencyToBin = [binWidth](double frequency)
+    {
+        return juce::jlimit(1, numBins - 1, juce::roundToInt(frequency / binWidth));
+    };
+
+    for (int x = 0; x < width; ++x)
+    {
+        auto low = juce::mapToLog10(double(x) / double(width), 20.0, 20000.0);
+        auto high = juce::mapToLog10(double(x + 1) / double(width), 20.0, 20000.0);
+
+        pixelBins[static_cast<size_t>(x)] = { frequencyToBin(low), juce::jmax(frequencyToBin(low), frequencyToBin(high) - 1) };
+    }
+}
+
+void SpectrumAnalyser::createPath(juce::Path& path, juce::Rectangle<float> bounds, double sampleRate,
+                                  float minDecibels, float maxDecibels)
+{
+    path.clear();
+
+    auto width = static_cast<int>(bounds.getWidth());
+
+    if (width <= 0 || sampleRate <= 0.0)
+        return;
+
+    updatePixelBins(width, sampleRate);
+
+    auto map = [&](float decibels)
+    {
+        return juce::jmap(juce::jlimit(minDecibels, maxDecibels, decibels),
+                          minDecibels, maxDecibels, bounds.getBottom(), bounds.getY());
+    };
+
+    for (int x = 0; x < width; ++x)
+    {
+        // Where several bins share a pixel, show the loudest.
+        auto bins = pixelBins[static_cast<size_t>(x)];
+        auto level = *std::max_element(levels.begin() + bins.first, levels.begin() + bins.second + 1);
+
+        auto px = bounds.getX() + static_cast<float>(x);
+
+        if (x == 0)
+            path.startNewSubPath(px, map(level));
+        else
+            path.lineTo(px, map(level));
+    }
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyser.h
+    Message thread side of the spectrum analyser: windowed FFT of the samples
+    arriving through an AnalyserFifo, smoothed and reduced to one value per
+    pixel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#include "AnalyserFifo.h"
+
+class SpectrumAnalyser
+{
+public:
+    explicit SpectrumAnalyser(AnalyserFifo& source);
+
+    // Drains the FIFO and, if enough new samples arrived, runs one FFT.
+    // Returns true if the spectrum changed. At most one FFT per call, so the
+    // cost per GUI frame is fixed however far behind the consumer is.
+    bool process();
+
+    // Rebuilds `path` across `bounds`, log spaced from 20 Hz to 20 kHz like
+    // the response curve, with levels from minDecibels to maxDecibels.
+    void createPath(juce::Path& path, juce::Rectangle<float> bounds, double sampleRate,
+                    float minDecibels, float maxDecibels);
+
+private:
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int numBins = fftSize / 2;
+    static constexpr int hopSize = fftSize / 4;
+
+    // Fraction of the way a falling bin moves towards its new level per FFT.
+    static constexpr float releaseCoefficient = 0.25f;
+
+    static constexpr float floorDecibels = -120.f;
+
+    void updatePixelBins(int width, double sampleRate);
+
+    AnalyserFifo& fifo;
+
+    juce::dsp::FFT fft{ fftOrder };
+    juce::dsp::WindowingFunction<float> window{ static_cast<size_t>(fftSize),
+                                                juce::dsp::WindowingFunction<float>::hann };
+
+    std::vector<float> history, incoming, fftData, levels;
+    int historyPosition{ 0 };
+    int samplesSinceLastTransform{ 0 };
+
+    // First and last bin shown by each pixel.
+    std::vector<std::pair<int, int>> pixelBins;
+    double pixelBinsSampleRate{ 0.0 };
+};
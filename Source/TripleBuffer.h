@@ -0,0 +1,53 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Wait-free single-producer / single-consumer exchange of the latest value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/**
+    Hands the most recent value from one writer thread to one reader thread.
+
+    The writer fills getWriteBuffer() and calls publish(); the reader calls
+    acquire(), which returns the newest published value or nullptr when nothing
+    new arrived since the last call. Neither side ever blocks or allocates, and
+    values published while the reader is busy are simply superseded.
+*/
+template<typename ValueType>
+class TripleBuffer
+{
+public:
+    TripleBuffer() = default;
+
+    ValueType& getWriteBuffer() noexcept { return buffers[writeIndex]; }
+
+    void publish() noexcept
+    {
+        writeIndex = middle.exchange(writeIndex | freshBit, std::memory_order_acq_rel) & indexMask;
+    }
+
+    const ValueType* acquire() noexcept
+    {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+            return nullptr;
+
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+        return &buffers[readIndex];
+    }
+
+private:
+    static constexpr int indexMask = 3;
+    static constexpr int freshBit = 4;
+
+    std::array<ValueType, 3> buffers;
+    int writeIndex{ 0 }, readIndex{ 2 };
+    std::atomic<int> middle{ 1 };
+
+    JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};